@@ -0,0 +1,79 @@
+#include "animationdriver.h"
+#include <QScreen>
+
+// 构造函数
+// target: 需要重绘的窗口
+AnimationDriver::AnimationDriver(QWidget* target)
+    : QObject(target), target(target)
+{
+    pool.resize(poolSize);
+    freeSlots.reserve(poolSize);
+    for (int i = poolSize - 1; i >= 0; --i) freeSlots.append(i);
+    clock.start();
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer, &QTimer::timeout, this, &AnimationDriver::tick);
+}
+
+// 开始一个动画
+// type: 动画类型
+// duration: 持续时间（毫秒），0表示循环播放
+Animation* AnimationDriver::start(AnimationType type, int duration)
+{
+    if (freeSlots.isEmpty()) return nullptr; // 对象池耗尽，放弃这个动画
+    Animation& anim = pool[freeSlots.takeLast()];
+    anim.type = type;
+    anim.active = true;
+    anim.start = clock.elapsed();
+    anim.duration = duration;
+    anim.progress = 0;
+    anim.pointCount = 0;
+    anim.form = -1;
+    ++activeCount;
+    if (!frameTimer.isActive()) {
+        // 帧间隔与屏幕刷新率一致
+        qreal rate = target->screen() ? target->screen()->refreshRate() : 60.0;
+        frameTimer.start(qMax(1, qRound(1000.0 / (rate > 0 ? rate : 60.0))));
+    }
+    return &anim;
+}
+
+// 停止某一类型的所有动画
+void AnimationDriver::stop(AnimationType type)
+{
+    for (int i = 0; i < pool.size(); ++i) {
+        if (pool[i].active && pool[i].type == type) {
+            pool[i].active = false;
+            freeSlots.append(i);
+            --activeCount;
+        }
+    }
+    target->update();
+}
+
+// 获取对象池中的所有动画
+const QVector<Animation>& AnimationDriver::animations() const
+{
+    return pool;
+}
+
+// 推进一帧
+void AnimationDriver::tick()
+{
+    qint64 now = clock.elapsed();
+    for (int i = 0; i < pool.size(); ++i) {
+        Animation& anim = pool[i];
+        if (!anim.active) continue;
+        qint64 elapsed = now - anim.start;
+        if (anim.duration <= 0) {
+            anim.progress = (elapsed % 1000) / 1000.0; // 循环动画以1秒为一个周期
+        } else if (elapsed >= anim.duration) {
+            anim.active = false; // 播放结束，放回对象池
+            freeSlots.append(i);
+            --activeCount;
+        } else {
+            anim.progress = qreal(elapsed) / anim.duration;
+        }
+    }
+    if (activeCount == 0) frameTimer.stop();
+    target->update(); // 每帧只请求一次重绘
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <QObject>
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QPoint>
+#include <array>
+
+// 动画类型
+enum class AnimationType {
+    PathFade,   // 消除路径淡出
+    BlockPop,   // 被消除方块的弹出效果
+    HintPulse,  // Hint高亮脉动，持续到被停止
+    PropSpawn,  // 道具出现时的放大效果
+    PlayerSlide // 玩家在两步模拟之间从上一格移向新格，form为玩家编号
+};
+
+// 单个动画
+// 动画对象保存在驱动器的对象池中循环复用，播放过程中不分配内存
+struct Animation {
+    AnimationType type = AnimationType::PathFade; // 动画类型
+    bool active = false;                 // 是否正在播放
+    qint64 start = 0;                    // 开始时间（毫秒，动画时钟）
+    int duration = 0;                    // 持续时间（毫秒），0表示循环播放直到被停止
+    qreal progress = 0;                  // 当前进度（0-1），循环动画为当前周期内的进度
+    std::array<QPoint, 4> points;        // 路径点或格子的地图坐标
+    int pointCount = 0;                  // 有效的点数
+    int form = -1;                       // BlockPop使用的方块形状，PlayerSlide使用的玩家编号
+};
+
+// 动画驱动器
+// 所有动画共用一个精确的帧时钟，每个显示帧统一推进进度并只请求一次重绘
+// 没有动画播放时帧时钟自动停止，不产生额外的唤醒
+class AnimationDriver : public QObject
+{
+    Q_OBJECT
+public:
+    // 构造函数
+    // target: 需要重绘的窗口
+    // 预先分配动画对象池，帧间隔按屏幕刷新率设置
+    explicit AnimationDriver(QWidget* target);
+
+    // 开始一个动画
+    // type: 动画类型
+    // duration: 持续时间（毫秒），0表示循环播放
+    // 返回对象池中取出的动画，调用方填写点坐标等参数；对象池耗尽时返回nullptr
+    Animation* start(AnimationType type, int duration);
+
+    // 停止某一类型的所有动画
+    // type: 动画类型
+    void stop(AnimationType type);
+
+    // 获取对象池中的所有动画
+    // 绘制时遍历并跳过未激活的动画
+    const QVector<Animation>& animations() const;
+
+private slots:
+    // 推进一帧
+    // 更新所有动画进度，回收已结束的动画，并请求一次重绘
+    void tick();
+
+private:
+    static const int poolSize = 32;      // 对象池容量
+    QWidget* target;                     // 需要重绘的窗口
+    QTimer frameTimer;                   // 帧时钟
+    QElapsedTimer clock;                 // 单调时钟，所有动画共用
+    QVector<Animation> pool;             // 动画对象池
+    QVector<int> freeSlots;              // 空闲的对象池下标
+    int activeCount = 0;                 // 正在播放的动画数量
+};
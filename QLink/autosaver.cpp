@@ -0,0 +1,120 @@
+#include "autosaver.h"
+#include "movejournal.h"
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+// 构造函数
+// path: 自动存档文件路径
+AutoSaver::AutoSaver(const QString& path)
+    : path(path)
+    , journalPath(path + ".journal")
+{
+    worker.setMaxThreadCount(1);
+}
+
+// 析构函数
+AutoSaver::~AutoSaver()
+{
+    worker.waitForDone();
+}
+
+// 提交一份存档快照
+// data: 游戏状态快照
+void AutoSaver::submit(const SaveData& data)
+{
+    QMutexLocker<QMutex> locker(&mutex);
+    if (discarded || path.isEmpty()) return;
+    latest = data;
+    queued = true;
+    records.clear();
+    if (running) return; // 后台线程写完当前快照后会继续取走这一份
+    running = true;
+    worker.start([this]() { drain(); });
+}
+
+// 追加日志记录
+// newRecords: 新增的日志记录
+void AutoSaver::append(const QByteArray& newRecords)
+{
+    if (newRecords.isEmpty()) return;
+    QMutexLocker<QMutex> locker(&mutex);
+    if (discarded || path.isEmpty()) return;
+    records += newRecords;
+    if (running) return;
+    running = true;
+    worker.start([this]() { drain(); });
+}
+
+// 丢弃自动存档
+// 工作池只有一个线程，删除任务一定在进行中的写入之后执行；写盘循环看到队列已清空会直接退出
+void AutoSaver::discard()
+{
+    {
+        QMutexLocker<QMutex> locker(&mutex);
+        discarded = true;
+        queued = false;
+        records.clear();
+    }
+    if (path.isEmpty()) return;
+    worker.start([this]() {
+        QFile::remove(journalPath);
+        QFile::remove(path);
+    });
+}
+
+// 后台线程写盘循环
+void AutoSaver::drain()
+{
+    for (;;) {
+        SaveData data;
+        bool snapshot;
+        QByteArray tail;
+        {
+            QMutexLocker<QMutex> locker(&mutex);
+            if (!queued && records.isEmpty()) {
+                running = false;
+                return;
+            }
+            snapshot = queued;
+            if (snapshot) data = latest;
+            tail = records;
+            queued = false;
+            records.clear();
+        }
+        if (snapshot) {
+            // 先删旧日志再写快照：中途崩溃最多退回上一份快照，不会把旧日志重放到新快照上
+            // saveGame经QSaveFile写入：commit时同步到磁盘再原子重命名
+            QFile::remove(journalPath);
+            saveGame(path, data);
+        }
+        if (!tail.isEmpty()) {
+            QFile journal(journalPath);
+            if (journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+                journal.write(tail);
+                journal.flush();
+            }
+        }
+    }
+}
+
+// 获取自动存档路径
+// mode: 游戏模式
+QString AutoSaver::pathFor(GameMode mode)
+{
+    if (QStandardPaths::isTestModeEnabled()) return QString();
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + (mode == GameMode::Single ? "/autosave-single.qsav" : "/autosave-duo.qsav");
+}
+
+// 恢复自动存档
+// path: 自动存档文件路径
+// data: 用于存储恢复的游戏数据
+bool AutoSaver::restore(const QString& path, SaveData& data)
+{
+    if (!loadGame(path, data)) return false;
+    QFile journal(path + ".journal");
+    if (journal.open(QIODevice::ReadOnly)) MoveJournal::replay(journal.readAll(), data);
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <QString>
+#include <QMutex>
+#include <QThreadPool>
+#include "load.h"
+
+// 后台自动存档器
+// GUI线程只负责取一份写时复制的存档快照，编码、写盘和同步都在后台线程完成
+// 写入经过临时文件并原子重命名，写到一半崩溃也不会损坏上一份自动存档
+// 后台线程忙时新快照只保留最新的一份，不会排队堆积
+// 两次快照之间的状态变化以日志记录追加到"<存档路径>.journal"，每次只写入几个字节
+class AutoSaver
+{
+public:
+    // 构造函数
+    // path: 自动存档文件路径，为空时不写任何文件
+    explicit AutoSaver(const QString& path);
+
+    // 析构函数
+    // 等待正在进行的写入完成
+    ~AutoSaver();
+
+    // 提交一份存档快照
+    // data: 游戏状态快照，隐式共享的成员只增加引用计数
+    // 立即返回，不等待磁盘I/O
+    // 快照写入后清空旧日志，尚未写入的日志记录一并丢弃（快照已包含它们的效果）
+    void submit(const SaveData& data);
+
+    // 追加日志记录
+    // newRecords: MoveJournal::takePending()取出的记录
+    // 立即返回，由后台线程追加到日志文件末尾
+    void append(const QByteArray& newRecords);
+
+    // 丢弃自动存档
+    // 取消尚未写入的快照和日志，删除存档文件的任务排在进行中的写入之后，立即返回
+    // 在游戏正常结束或主动退出时调用，之后提交的快照和日志都被忽略
+    void discard();
+
+    // 获取自动存档路径
+    // mode: 游戏模式
+    // 返回应用数据目录下对应模式的自动存档路径，目录不存在时创建；测试模式下返回空路径，不写自动存档
+    static QString pathFor(GameMode mode);
+
+    // 恢复自动存档
+    // path: 自动存档文件路径
+    // data: 用于存储恢复的游戏数据
+    // 返回是否恢复成功：读取完整快照后重放其后的日志
+    static bool restore(const QString& path, SaveData& data);
+
+private:
+    // 后台线程：不断取出最新快照写盘，直到没有新快照
+    void drain();
+
+    QString path;           // 自动存档文件路径
+    QString journalPath;    // 日志文件路径
+    QThreadPool worker;     // 单线程写盘工作池
+    QMutex mutex;           // 保护下面五个成员
+    SaveData latest;        // 等待写入的最新快照
+    bool queued = false;    // 是否有等待写入的快照
+    QByteArray records;     // 等待追加的日志记录
+    bool running = false;   // 后台线程是否正在写盘
+    bool discarded = false; // 是否已丢弃，之后的提交都被忽略
+};
@@ -1,5 +1,7 @@
 #include "block.h"
 #include <QDebug>
+#include <QRandomGenerator>
+#include <utility>
 
 // 默认构造函数
 Block::Block()
@@ -109,3 +111,31 @@ int Block::getMapY() const
 {
 	return mapY; // 返回地图y坐标
 }
+
+// 生成洗牌排列
+// count: 参与洗牌的方块数
+// seed: 随机种子
+QVector<int> shufflePermutation(int count, quint32 seed)
+{
+	QVector<int> order(count);
+	for (int i = 0; i < count; ++i) order[i] = i;
+	// Fisher-Yates洗牌，只依赖种子，保证重放结果一致
+	QRandomGenerator rng(seed);
+	for (int i = count - 1; i > 0; --i)
+		std::swap(order[i], order[rng.bounded(i + 1)]);
+	return order;
+}
+
+// 对压缩棋盘洗牌
+// cells: 压缩棋盘
+// seed: 随机种子
+void shuffleCells(QByteArray& cells, quint32 seed)
+{
+	QVector<int> positions;
+	for (int i = 0; i < cells.size(); ++i)
+		if (packedState(uchar(cells[i])) != 0) positions.append(i);
+	QVector<int> order = shufflePermutation(positions.size(), seed);
+	QByteArray original = cells;
+	for (int idx = 0; idx < positions.size(); ++idx)
+		cells[positions[idx]] = original[positions[order[idx]]];
+}
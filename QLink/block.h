@@ -1,6 +1,32 @@
 #pragma once
 #include <QWidget>
 #include <QRectF>
+#include <QVector>
+#include <QByteArray>
+
+// 将方块的形状和状态压缩为一个字节
+// form: 方块形状，-1表示无形状
+// state: 方块状态
+// 高4位为形状+1，低4位为状态，空格子压缩结果的低4位为0
+inline uchar packBlock(int form, int state) { return uchar((((form + 1) & 0x0F) << 4) | (state & 0x0F)); }
+
+// 取出压缩字节中的方块形状
+inline int packedForm(uchar cell) { return (cell >> 4) - 1; }
+
+// 取出压缩字节中的方块状态
+inline int packedState(uchar cell) { return cell & 0x0F; }
+
+// 生成洗牌排列
+// count: 参与洗牌的方块数
+// seed: 随机种子
+// 返回0..count-1的一个排列，相同种子总是得到相同排列，用于记录和重放洗牌
+QVector<int> shufflePermutation(int count, quint32 seed);
+
+// 对压缩棋盘洗牌
+// cells: 压缩棋盘，每格一个字节（见packBlock），按行存储
+// seed: 随机种子
+// 与游戏内洗牌使用同一排列：按行优先顺序收集未消除的格子，再按排列重新放置
+void shuffleCells(QByteArray& cells, quint32 seed);
 
 // 游戏方块类
 // 继承自QWidget，表示连连看游戏中的一个方块
@@ -0,0 +1,158 @@
+#include "boardcodec.h"
+#include "block.h"
+#include <QVector>
+
+// 追加一个变长整数（每字节7位，最高位表示后面还有字节）
+static void appendVarint(QByteArray& out, quint32 value) {
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+// 变长整数占用的字节数
+static int varintSize(quint32 value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+// 读取一个变长整数并前移读指针
+// 数据不足或超过5个字节时返回false
+static bool takeVarint(const char*& p, const char* end, quint32& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uchar byte = uchar(*p++);
+        value |= quint32(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// 追加每个2位的符号序列，低位在前
+static void appendSymbols(QByteArray& out, const QVector<uchar>& symbols) {
+    int start = out.size();
+    out.append(QByteArray((symbols.size() + 3) / 4, 0));
+    char* bits = out.data() + start;
+    for (int i = 0; i < symbols.size(); ++i)
+        bits[i >> 2] = char(bits[i >> 2] | (symbols[i] << ((i & 3) * 2)));
+}
+
+// 压缩编码棋盘
+// cells: 压缩棋盘
+QByteArray encodeBoard(const QByteArray& cells) {
+    const int count = cells.size();
+    QVector<uchar> symbols(count);   // 每格的2位符号
+    QVector<int> filled;             // 非空格子下标
+    QVector<int> active;             // 激活格子下标
+    for (int i = 0; i < count; ++i) {
+        uchar cell = uchar(cells[i]);
+        int form = packedForm(cell), state = packedState(cell);
+        if (state == 0) {
+            symbols[i] = 0;
+            continue;
+        }
+        if (form < 0 || form > 2 || state > 2) {
+            // 无法用2位表示，原样存储
+            QByteArray raw(1, char(BoardEncoding::Raw));
+            return raw + cells;
+        }
+        symbols[i] = uchar(form + 1);
+        filled.append(i);
+        if (state == 2) active.append(i);
+    }
+
+    // 两种编码的长度都可以直接算出，按密度选较小的一种
+    int packedSize = (count + 3) / 4;
+    int runLengthSize = varintSize(filled.size()) + (filled.size() + 3) / 4;
+    for (int k = 0, last = 0; k < filled.size(); last = filled[k++] + 1)
+        runLengthSize += varintSize(filled[k] - last);
+
+    QByteArray out;
+    if (runLengthSize < packedSize) {
+        out.reserve(1 + runLengthSize + 8);
+        out.append(char(BoardEncoding::RunLength));
+        appendVarint(out, filled.size());
+        QVector<uchar> forms(filled.size());
+        for (int k = 0, last = 0; k < filled.size(); last = filled[k++] + 1) {
+            appendVarint(out, filled[k] - last);
+            forms[k] = symbols[filled[k]];
+        }
+        appendSymbols(out, forms);
+    } else {
+        out.reserve(1 + packedSize + 8);
+        out.append(char(BoardEncoding::Packed));
+        appendSymbols(out, symbols);
+    }
+    // 激活格子通常只有一两个，单独按下标差值存储
+    appendVarint(out, active.size());
+    for (int k = 0, last = 0; k < active.size(); last = active[k++])
+        appendVarint(out, active[k] - last);
+    return out;
+}
+
+// 解码棋盘
+// data: 编码数据起始地址
+// size: 编码数据字节数
+// cellCount: 棋盘格子数
+// cells: 用于存储解码后的压缩棋盘
+bool decodeBoard(const char* data, int size, int cellCount, QByteArray& cells) {
+    if (size < 1) return false;
+    const char* p = data + 1;
+    const char* end = data + size;
+    const BoardEncoding encoding = static_cast<BoardEncoding>(uchar(data[0]));
+    if (encoding == BoardEncoding::Raw) {
+        if (end - p != cellCount) return false;
+        cells = QByteArray(p, cellCount);
+        return true;
+    }
+    QByteArray result(cellCount, 0);
+    char* out = result.data();
+    if (encoding == BoardEncoding::Packed) {
+        const int bytes = (cellCount + 3) / 4;
+        if (end - p < bytes) return false;
+        for (int i = 0; i < cellCount; ++i) {
+            int symbol = (uchar(p[i >> 2]) >> ((i & 3) * 2)) & 3;
+            if (symbol) out[i] = char(packBlock(symbol - 1, 1));
+        }
+        p += bytes;
+    } else if (encoding == BoardEncoding::RunLength) {
+        quint32 filled;
+        if (!takeVarint(p, end, filled) || filled > quint32(cellCount)) return false;
+        QVector<int> positions(filled);
+        quint32 next = 0;
+        for (quint32 k = 0; k < filled; ++k) {
+            quint32 gap;
+            if (!takeVarint(p, end, gap) || gap >= quint32(cellCount) - next) return false;
+            positions[k] = next + gap;
+            next += gap + 1;
+        }
+        const int bytes = (filled + 3) / 4;
+        if (end - p < bytes) return false;
+        for (quint32 k = 0; k < filled; ++k) {
+            int symbol = (uchar(p[k >> 2]) >> ((k & 3) * 2)) & 3;
+            if (!symbol) return false;
+            out[positions[k]] = char(packBlock(symbol - 1, 1));
+        }
+        p += bytes;
+    } else {
+        return false;
+    }
+    // 激活格子
+    quint32 activeCount;
+    if (!takeVarint(p, end, activeCount) || activeCount > quint32(cellCount)) return false;
+    for (quint32 k = 0, index = 0; k < activeCount; ++k) {
+        quint32 delta;
+        if (!takeVarint(p, end, delta) || delta >= quint32(cellCount) - index) return false;
+        index += delta;
+        if (packedState(uchar(out[index])) == 0) return false;
+        out[index] = char((uchar(out[index]) & 0xF0) | 2);
+    }
+    if (p != end) return false;
+    cells = result;
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <QByteArray>
+
+// 棋盘编码方式
+enum class BoardEncoding : quint8 {
+    Raw = 0,        // 原样存储，每格一个字节
+    Packed = 1,     // 每格2位：0为空格子，1-3为形状+1；激活格子另存下标
+    RunLength = 2   // 只存非空格子：空格子游程长度（变长整数）加每格2位的形状；激活格子另存下标
+};
+
+// 压缩编码棋盘
+// cells: 压缩棋盘，每格一个字节（见packBlock），按行存储
+// 返回一个字节的编码方式加编码数据
+// 按非空格子的密度在Packed和RunLength中选较小的一种，无法用2位表示的棋盘退回Raw；
+// 已消除格子的形状不再影响对局，编码时统一视为空格子
+QByteArray encodeBoard(const QByteArray& cells);
+
+// 解码棋盘
+// data: 编码数据起始地址
+// size: 编码数据字节数
+// cellCount: 棋盘格子数（行数×列数）
+// cells: 用于存储解码后的压缩棋盘
+// 返回数据是否有效；数据被截断或与格子数不符时返回false
+bool decodeBoard(const char* data, int size, int cellCount, QByteArray& cells);
@@ -0,0 +1,98 @@
+#include "boardhistory.h"
+#include <cstring>
+
+static const int boardChunkRows = 16; // 每个行块的行数
+
+// 从压缩棋盘构造
+// rows, cols: 地图行数和列数
+// cells: 按行存储的压缩棋盘
+BoardVersion::BoardVersion(int rows, int cols, const QByteArray& cells)
+    : rowCount(rows), colCount(cols)
+{
+    chunks.resize((rows + boardChunkRows - 1) / boardChunkRows);
+    for (int r = 0; r < rows; ++r) {
+        QVector<QByteArray>& chunk = chunks[r / boardChunkRows];
+        chunk.append(cells.mid(r * cols, cols));
+    }
+}
+
+// 获取一格的压缩值
+uchar BoardVersion::at(int row, int col) const
+{
+    return uchar(this->row(row).at(col));
+}
+
+// 获取一行的压缩值
+const QByteArray& BoardVersion::row(int row) const
+{
+    return chunks.at(row / boardChunkRows).at(row % boardChunkRows);
+}
+
+// 修改一格，返回新版本
+BoardVersion BoardVersion::with(int row, int col, uchar cell) const
+{
+    BoardVersion next = *this;
+    if (at(row, col) == cell) return next;
+    // 三次写入依次使外层索引、行块和该行脱离共享，其余行块和行仍与本版本共用
+    next.chunks[row / boardChunkRows][row % boardChunkRows][col] = char(cell);
+    return next;
+}
+
+// 按新的压缩棋盘生成版本
+// cells: 按行存储的压缩棋盘
+BoardVersion BoardVersion::updated(const QByteArray& cells) const
+{
+    BoardVersion next = *this;
+    for (int r = 0; r < rowCount; ++r) {
+        const char* src = cells.constData() + r * colCount;
+        if (memcmp(row(r).constData(), src, colCount) != 0)
+            next.chunks[r / boardChunkRows][r % boardChunkRows] = QByteArray(src, colCount);
+    }
+    return next;
+}
+
+// 判断某一行是否与另一版本共享同一份数据
+bool BoardVersion::sharesRow(const BoardVersion& other, int row) const
+{
+    return this->row(row).constData() == other.row(row).constData();
+}
+
+// 展开为按行存储的压缩棋盘
+QByteArray BoardVersion::cells() const
+{
+    QByteArray result;
+    result.reserve(rowCount * colCount);
+    for (const QVector<QByteArray>& chunk : chunks)
+        for (const QByteArray& r : chunk) result.append(r);
+    return result;
+}
+
+// 清空历史，以step作为第一步
+void UndoHistory::reset(const UndoStep& step)
+{
+    steps.clear();
+    steps.append(step);
+    index = 0;
+}
+
+// 记录新步骤
+void UndoHistory::push(const UndoStep& step)
+{
+    steps.resize(index + 1); // 丢弃可重做的步骤
+    steps.append(step);
+    ++index;
+}
+
+// 撤销一步
+const UndoStep& UndoHistory::undo()
+{
+    if (canUndo()) --index;
+    return steps[index];
+}
+
+// 重做一步
+const UndoStep& UndoHistory::redo()
+{
+    if (canRedo()) ++index;
+    return steps[index];
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <QByteArray>
+#include <QPoint>
+#include <QVector>
+
+// 持久化棋盘版本
+// 棋盘按行存为隐式共享的QByteArray，每boardChunkRows行再组成一块，两层都可以在版本之间共享
+// 修改一格只复制所在的行和两层索引，其余行与旧版本共用同一份数据
+class BoardVersion
+{
+public:
+    // 构造空棋盘
+    BoardVersion() = default;
+
+    // 从压缩棋盘构造
+    // rows, cols: 地图行数和列数
+    // cells: 按行存储的压缩棋盘，每格一个字节
+    BoardVersion(int rows, int cols, const QByteArray& cells);
+
+    int rows() const { return rowCount; } // 地图行数
+    int cols() const { return colCount; } // 地图列数
+
+    // 获取一格的压缩值
+    uchar at(int row, int col) const;
+
+    // 获取一行的压缩值
+    const QByteArray& row(int row) const;
+
+    // 修改一格，返回新版本
+    // 原版本不变，新版本只复制被修改的行
+    BoardVersion with(int row, int col, uchar cell) const;
+
+    // 按新的压缩棋盘生成版本
+    // cells: 按行存储的压缩棋盘，尺寸必须与本版本一致
+    // 内容相同的行继续共享，只有变化的行占用新的内存
+    BoardVersion updated(const QByteArray& cells) const;
+
+    // 判断某一行是否与另一版本共享同一份数据
+    // 共享的行内容一定相同，切换版本时可以跳过
+    bool sharesRow(const BoardVersion& other, int row) const;
+
+    // 展开为按行存储的压缩棋盘
+    QByteArray cells() const;
+
+private:
+    QVector<QVector<QByteArray>> chunks; // 行块，每块boardChunkRows行
+    int rowCount = 0, colCount = 0;      // 地图行数和列数
+};
+
+// 一个撤销步骤
+// 记录一次消除或洗牌之后的局面，棋盘与相邻步骤共享未变化的行
+struct UndoStep {
+    BoardVersion board;               // 棋盘
+    int score = 0;                    // 分数
+    QPoint playerPos;                 // 玩家位置
+    QPoint activePos{-1, -1};         // 激活的方块，没有时为(-1,-1)
+    QVector<QPoint> propPositions;    // 未被拾取的道具位置
+    QVector<int> propTypes;           // 道具类型
+};
+
+// 撤销/重做历史
+// 步骤数不设上限，撤销和重做只移动当前下标；在撤销后记录新步骤会丢弃可重做的步骤
+class UndoHistory
+{
+public:
+    // 清空历史，以step作为第一步
+    void reset(const UndoStep& step);
+
+    // 记录新步骤
+    void push(const UndoStep& step);
+
+    bool canUndo() const { return index > 0; }                  // 是否可以撤销
+    bool canRedo() const { return index + 1 < steps.size(); }   // 是否可以重做
+
+    // 撤销一步，返回撤销后的步骤；不能撤销时返回当前步骤
+    const UndoStep& undo();
+
+    // 重做一步，返回重做后的步骤；不能重做时返回当前步骤
+    const UndoStep& redo();
+
+    // 获取当前步骤，历史为空时不可调用
+    const UndoStep& current() const { return steps[index]; }
+
+    bool isEmpty() const { return steps.isEmpty(); } // 历史是否为空
+    int size() const { return steps.size(); }        // 步骤总数
+
+private:
+    QVector<UndoStep> steps; // 全部步骤
+    int index = -1;          // 当前步骤下标
+};
@@ -0,0 +1,97 @@
+#include "boardpipeline.h"
+#include "block.h"
+#include "hintsolver.h"
+#include <QMetaObject>
+
+// 按种子发牌
+// 先按对抽取形状，再抽取洗牌种子，抽取顺序与游戏窗口开局一致
+PreparedBoard dealBoard(quint32 seed, int rows, int cols, int formNum)
+{
+    PreparedBoard board;
+    board.seed = seed;
+    board.rows = rows;
+    board.cols = cols;
+    board.formNum = formNum;
+    board.rng = QRandomGenerator(seed);
+    board.cells = QByteArray(rows * cols, char(packBlock(-1, 0)));
+    for (int i = 2; i < rows - 2; ++i) {
+        for (int j = 2; j < cols - 2; j += 2) {
+            int randomForm = board.rng.bounded(formNum);
+            board.cells[i * cols + j] = char(packBlock(randomForm, 1));
+            board.cells[i * cols + j + 1] = char(packBlock(randomForm, 1));
+        }
+    }
+    shuffleCells(board.cells, board.rng.generate());
+    return board;
+}
+
+// 棋盘能否消完
+bool isBoardSolvable(QByteArray cells, int rows, int cols, const std::function<bool()>& cancelled)
+{
+    QPoint a, b;
+    while (findLinkPair(cells, rows, cols, a, b, cancelled)) {
+        cells[a.y() * cols + a.x()] = char(packBlock(-1, 0));
+        cells[b.y() * cols + b.x()] = char(packBlock(-1, 0));
+    }
+    if (cancelled && cancelled()) return false;
+    for (int i = 0; i < cells.size(); ++i)
+        if (packedState(uchar(cells[i])) != 0) return false;
+    return true;
+}
+
+// 构造函数
+BoardPipeline::BoardPipeline(int rows, int cols, int formNum, int capacity, QObject* parent)
+    : QObject(parent)
+    , rows(rows)
+    , cols(cols)
+    , formNum(formNum)
+    , capacity(capacity)
+{
+    worker.setMaxThreadCount(1);
+    refill();
+}
+
+// 析构函数
+BoardPipeline::~BoardPipeline()
+{
+    stopping.storeRelease(1);
+    worker.waitForDone();
+}
+
+// 生成一份能消完的棋盘
+// 种子取自全局随机数，可以在任意线程调用
+PreparedBoard BoardPipeline::generate(int rows, int cols, int formNum, const std::function<bool()>& cancelled)
+{
+    PreparedBoard board;
+    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+        board = dealBoard(QRandomGenerator::global()->generate(), rows, cols, formNum);
+        if (isBoardSolvable(board.cells, rows, cols, cancelled)) break;
+        if (cancelled && cancelled()) break;
+    }
+    return board;
+}
+
+// 取出一份棋盘
+PreparedBoard BoardPipeline::take()
+{
+    PreparedBoard board = ready.isEmpty() ? generate(rows, cols, formNum) : ready.takeFirst();
+    refill();
+    return board;
+}
+
+// 在后台补足队列
+// 生成好的棋盘送回GUI线程再入队，队列本身不需要加锁
+void BoardPipeline::refill()
+{
+    while (ready.size() + pending < capacity) {
+        ++pending;
+        worker.start([this]() {
+            PreparedBoard board = generate(rows, cols, formNum, [this]() { return stopping.loadAcquire() != 0; });
+            if (stopping.loadAcquire()) return;
+            QMetaObject::invokeMethod(this, [this, board]() {
+                --pending;
+                ready.append(board);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
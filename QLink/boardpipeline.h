@@ -0,0 +1,88 @@
+#pragma once
+#include <QObject>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QRandomGenerator>
+#include <QThreadPool>
+#include <QVector>
+#include <functional>
+
+// 开局的地图尺寸和形状种类数，游戏窗口和菜单中的流水线共用
+const int boardRows = 14;
+const int boardCols = 14;
+const int boardForms = 3;
+
+// 一份发好的开局棋盘
+struct PreparedBoard {
+    quint32 seed = 0;          // 对局随机种子
+    int rows = 0, cols = 0;    // 地图行数和列数
+    int formNum = 0;           // 方块形状种类数量
+    QByteArray cells;          // 发牌并洗牌后的压缩棋盘（见packBlock）
+    QRandomGenerator rng;      // 发牌后的对局随机数，开局后的随机事件从这里继续抽取
+
+    // 是否可用于指定的对局
+    bool matches(quint32 gameSeed, int gameRows, int gameCols, int gameForms) const {
+        return seed == gameSeed && rows == gameRows && cols == gameCols && formNum == gameForms && cells.size() == rows * cols;
+    }
+};
+
+// 按种子发牌
+// seed: 对局随机种子
+// rows, cols: 地图行数和列数
+// formNum: 方块形状种类数量
+// 与游戏窗口开局的规则相同：游戏区每行相邻两格放同一形状，再用对局随机数洗牌；相同种子总是得到相同棋盘
+PreparedBoard dealBoard(quint32 seed, int rows, int cols, int formNum);
+
+// 棋盘能否消完
+// cells: 压缩棋盘
+// rows, cols: 地图行数和列数
+// cancelled: 返回true时放弃检查，可以为空
+// 每次消除按行优先找到的第一对，直到清空或无对可消；能消完说明至少存在一种解法
+bool isBoardSolvable(QByteArray cells, int rows, int cols, const std::function<bool()>& cancelled = nullptr);
+
+// 后台开局棋盘流水线
+// 后台线程随机取种子发牌，只保留能消完的棋盘，放进有上限的队列；开新局时直接取出
+// 方块控件和贴图只能在GUI线程创建，流水线只负责发牌、洗牌和校验
+class BoardPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 构造函数
+    // rows, cols: 地图行数和列数
+    // formNum: 方块形状种类数量
+    // capacity: 队列中预先准备的棋盘数
+    // parent: 父对象
+    // 立即开始在后台填充队列
+    BoardPipeline(int rows, int cols, int formNum, int capacity = 3, QObject* parent = nullptr);
+
+    // 析构函数
+    // 放弃进行中的生成并等待后台线程结束
+    ~BoardPipeline();
+
+    // 取出一份棋盘
+    // 队列为空时当场生成；取出后在后台补足队列
+    PreparedBoard take();
+
+    // 队列中已准备好的棋盘数
+    int size() const { return ready.size(); }
+
+    // 生成一份能消完的棋盘
+    // rows, cols, formNum: 同构造函数
+    // cancelled: 返回true时放弃生成，可以为空
+    // 连续maxAttempts个种子都消不完时采用最后一个
+    static PreparedBoard generate(int rows, int cols, int formNum, const std::function<bool()>& cancelled = nullptr);
+
+    static const int maxAttempts = 32; // 每份棋盘最多尝试的种子数
+
+private:
+    void refill();                 // 在后台补足队列
+
+    int rows, cols;                // 地图行数和列数
+    int formNum;                   // 方块形状种类数量
+    int capacity;                  // 队列上限
+    QVector<PreparedBoard> ready;  // 已准备好的棋盘，只在GUI线程访问
+    int pending = 0;               // 已提交但还没送回的生成任务数
+    QThreadPool worker;            // 单线程后台工作池
+    QAtomicInt stopping;           // 析构时置1，后台线程据此放弃生成
+};
@@ -4,35 +4,60 @@
 #include <QDir>
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QResizeEvent>
 #include <QPainter>
 #include <QMessageBox>
 #include <QRandomGenerator>
 #include <queue>
 #include <algorithm>
+#include <cmath>
 #include <QDebug>
 #include <QPainterPath>
 #include <QLabel>
 #include "item.h"
-#include <QTimer>
+#include "packedboard.h"
 #include "load.h"
 #include "pausemenu.h"
 #include <QFileDialog>
+#include <QDateTime>
+#include "savelibrary.h"
+#include "savebrowser.h"
 #include <QMessageBox>
 
+// 获取方向键所属的玩家
+// key: Qt::Key
+// 返回玩家ID，WASD为1，方向键为2，其他按键为0
+static int movePlayer(int key) {
+    switch (key) {
+        case Qt::Key_W: case Qt::Key_S: case Qt::Key_A: case Qt::Key_D: return 1;
+        case Qt::Key_Up: case Qt::Key_Down: case Qt::Key_Left: case Qt::Key_Right: return 2;
+        default: return 0;
+    }
+}
+
 // 构造函数
 // saveData: 存档数据指针，用于加载游戏状态，默认为nullptr
+// seed: 对局随机种子
+// headless: 是否为无窗口重放
+// board: 后台预先发好的开局棋盘，可以为空
 // 初始化双人模式游戏窗口，设置游戏界面和逻辑
-DuoMode::DuoMode(QWidget *parent, const SaveData* saveData)
+DuoMode::DuoMode(QWidget *parent, const SaveData* saveData, quint32 seed, bool headless, const PreparedBoard* board)
     : QMainWindow(parent)
     , ui(new Ui::DuoModeClass())
+    , seed(seed)
+    , rng(seed)
+    , headless(headless)
 {
     blockWidth = 50;
     blockHeight = 50;
     ui->setupUi(this);
+    animations = new AnimationDriver(this);
     
     this->setWindowModality(Qt::WindowModal);
-    this->setFixedSize(1200, 800);
-    this->setStyleSheet("DuoMode { background-image: url(:/images/images/background2.png); }");
+    this->resize(1200, 800); // 窗口可自由缩放，格子尺寸在resizeEvent中重新计算
+    // 背景图只解码一次，按窗口尺寸缩放后缓存，绘制时整窗覆盖，无需先擦除背景
+    backgroundSource = QPixmap(":/images/images/background2.png");
+    setAttribute(Qt::WA_OpaquePaintEvent);
     setWindowFlags(windowFlags() & ~Qt::WindowCloseButtonHint); // 禁用右上角关闭
 
     ui->exitBtn->setStyleSheet("color: rgb(147, 218, 100);");
@@ -53,53 +78,19 @@ DuoMode::DuoMode(QWidget *parent, const SaveData* saveData)
     progressBar->setStyleSheet("QProgressBar{height:22px; text-align:center; font-size:14px; color:white; border-radius:4px; background:rgb(147, 218, 100);}"
                                "QProgressBar::chunk{border-radius:4px;background:qlineargradient(spread:pad,x1:0,y1:0,x2:1,y2:0,stop:0 rgb(147, 218, 100),stop:1 rgb(205,218,224));}");
     
-    progressTimer = new QTimer(this);
-    connect(progressTimer, &QTimer::timeout, this, &DuoMode::progress);
-    progressTimer->start(1000);
-    
-    // 道具定时器
-    propTimer = new QTimer(this);
-    connect(propTimer, &QTimer::timeout, this, &DuoMode::generateProp);
-    propTimer->start(30000); // 30秒
-    
-    // 各种道具定时器初始化
-    hintTimer = new QTimer(this);
-    freezeTimer1 = new QTimer(this);
-    freezeTimer2 = new QTimer(this);
-    dizzyTimer1 = new QTimer(this);
-    dizzyTimer2 = new QTimer(this);
-    
-    connect(hintTimer, &QTimer::timeout, this, [this]() {
-        hintActive = false;
-        hintBlock1 = QPoint(-1, -1);
-        hintBlock2 = QPoint(-1, -1);
-        hintTimer->stop();
-        update();
-    });
-    
-    connect(freezeTimer1, &QTimer::timeout, this, [this]() {
-        freezeActive1 = false;
-        freezeTimer1->stop();
-        update();
-    });
-    
-    connect(freezeTimer2, &QTimer::timeout, this, [this]() {
-        freezeActive2 = false;
-        freezeTimer2->stop();
-        update();
-    });
-    
-    connect(dizzyTimer1, &QTimer::timeout, this, [this]() {
-        dizzyActive1 = false;
-        dizzyTimer1->stop();
-        update();
-    });
-    
-    connect(dizzyTimer2, &QTimer::timeout, this, [this]() {
-        dizzyActive2 = false;
-        dizzyTimer2->stop();
-        update();
-    });
+    // 倒计时、道具生成、自动存档和道具效果都由同一个调度器按游戏时间触发
+    // 无窗口时使用手动时钟，由调用方快进
+    scheduler = new GameScheduler(this, headless);
+    connect(scheduler, &GameScheduler::fired, this, &DuoMode::onTimer);
+    // 状态变化的订阅者：先写日志，再刷新显示和判定
+    connect(this, &DuoMode::gameEvent, this, [this](const GameEvent& event) { journal.record(event); });
+    connect(this, &DuoMode::gameEvent, this, &DuoMode::onGameEvent);
+    connect(&hintSolver, &HintSolver::solved, this, &DuoMode::onHintSolved);
+    if (!headless) {
+        scheduler->schedule(GameTimer::Progress, 1000, 1000);
+        scheduler->schedule(GameTimer::Prop, 30000, 30000);      // 30秒
+        scheduler->schedule(GameTimer::Autosave, 60000, 60000);  // 60秒
+    }
     
     // blocks初始化为rows*cols，边界为state=0，游戏区后面填充
     blocks.resize(rows);
@@ -116,26 +107,22 @@ DuoMode::DuoMode(QWidget *parent, const SaveData* saveData)
     }
     
     // 生成有效方块区
-    QVector<Block*> gameBlocks;
-    for (int i = 2; i < rows-2; ++i) {
-        for (int j = 2; j < cols-2; j += 2) {
-            int randomForm = QRandomGenerator::global()->bounded(formNum);
-            Block* b1 = new Block(topX + j * blockWidth, topY + i * blockHeight, blockWidth, blockHeight, randomForm, 1);
-            Block* b2 = new Block(topX + (j + 1) * blockWidth, topY + i * blockHeight, blockWidth, blockHeight, randomForm, 1);
-            b1->setMapXY(j, i);
-            b2->setMapXY(j + 1, i);
-            gameBlocks.append(b1);
-            gameBlocks.append(b2);
-        }
-    }
-    int idx = 0;
+    // 有后台预先发好的同种子棋盘时直接使用，否则当场发牌，两者得到的棋盘和随机数状态相同
+    if (board && !board->matches(seed, rows, cols, formNum))
+        qWarning() << "预先发好的棋盘与本局不符，当场发牌";
+    const PreparedBoard dealt = board && board->matches(seed, rows, cols, formNum) ? *board : dealBoard(seed, rows, cols, formNum);
+    rng = dealt.rng;
     for (int i = 2; i < rows-2; ++i) {
         for (int j = 2; j < cols-2; ++j) {
-            blocks[i][j] = gameBlocks[idx++];
+            const int form = packedForm(uchar(dealt.cells[i * cols + j]));
+            blocks[i][j] = new Block(topX + j * blockWidth, topY + i * blockHeight, blockWidth, blockHeight, form, 1);
+            blocks[i][j]->setMapXY(j, i);
         }
     }
-    shuffle();
+    syncPackedCells();
     initTextures();
+    // 超大棋盘或设置了QLINK_TILED_RENDER环境变量时，改用分块并行渲染
+    tiledRender = rows * cols >= 64 * 64 || qEnvironmentVariableIsSet("QLINK_TILED_RENDER");
     this->setFocusPolicy(Qt::StrongFocus);
     
     // 创建两个玩家
@@ -160,17 +147,28 @@ DuoMode::DuoMode(QWidget *parent, const SaveData* saveData)
     updateScoreLabels();
 
     // 游戏开始时立即生成一个道具（确保不在玩家起始位置）
+    props.reset(rows, cols);
+    rebuildFreeCells();
     generateProp();
     
     // 如果有存档数据，应用存档
     if (saveData) applySaveData(*saveData);
+    // 开局状态作为第一个关键帧，之后的随机事件都从关键帧的种子开始
+    markKeyframe();
+    // 日志从这份快照开始记录
+    autosave(true);
+    // 设置了QLINK_RECORD_REPLAY环境变量时录制新开的对局，读档的对局无法从种子复现
+    if (!saveData && !headless && qEnvironmentVariableIsSet("QLINK_RECORD_REPLAY"))
+        recorder.start(GameMode::Duo, seed);
+    // 开局棋盘交给后台查找：预先算好Hint方块对，发到死局时按策略处理
+    updateHint();
 }
 
 // 析构函数
 // 清理游戏资源，停止定时器，删除动态分配的对象
 DuoMode::~DuoMode()
 {
-    for (Item* prop : props) delete prop;
+    if (qEnvironmentVariableIsSet("QLINK_LATENCY_REPORT")) qInfo().noquote() << latency.report();
     delete ui;
 }
 
@@ -183,7 +181,7 @@ void DuoMode::updateScore(int delta, int playerId) {
     } else {
         score2 += delta;
     }
-    updateScoreLabels();
+    emit gameEvent(GameEvent::scoreChanged(playerId, playerId == 1 ? score1 : score2));
 }
 
 // 更新分数显示
@@ -192,36 +190,27 @@ void DuoMode::updateScoreLabels() {
     score2Label->setText(QString("P2: %1").arg(score2));
 }
 
-// 检查游戏是否结束
-// 如果没有可消除对，游戏结束并判定胜负
-void DuoMode::checkGameOver() {
-    for (int i = 2; i < rows - 2; ++i) {
-        for (int j = 2; j < cols - 2; ++j) {
-            Block* b1 = blocks[i][j];
-            if (!b1 || b1->getState() == 0) continue;
-            for (int ii = 2; ii < rows - 2; ++ii) {
-                for (int jj = 2; jj < cols - 2; ++jj) {
-                    if (i == ii && j == jj) continue;
-                    Block* b2 = blocks[ii][jj];
-                    if (!b2 || b2->getState() == 0) continue;
-                    if (b1->getForm() == b2->getForm() && canLink(b1->getMapX(), b1->getMapY(), b2->getMapX(), b2->getMapY())) {
-                        return;
-                    }
-                }
-            }
-        }
-    }
-    progressTimer->stop();
+// 结束对局
+// reason: 结束原因，"游戏结束"或"时间到"
+void DuoMode::finishGame(const QString& reason) {
+    scheduler->clear(); // 停止所有定时事件，结束弹窗不阻塞，关闭前不能再生成道具或自动存档
+    finished = true;
+    recorder.finish(score1, score2, packedBoard());
+    if (headless) return;
+    autosaver.discard();
     QString result;
     if (score1 > score2) {
-        result = QString("游戏结束！玩家1获胜！\n玩家1: %1分  玩家2: %2分").arg(score1).arg(score2);
+        result = QString("%1！玩家1获胜！\n玩家1: %2分  玩家2: %3分").arg(reason).arg(score1).arg(score2);
     } else if (score2 > score1) {
-        result = QString("游戏结束！玩家2获胜！\n玩家1: %1分  玩家2: %2分").arg(score1).arg(score2);
+        result = QString("%1！玩家2获胜！\n玩家1: %2分  玩家2: %3分").arg(reason).arg(score1).arg(score2);
     } else {
-        result = QString("游戏结束！平局！\n玩家1: %1分  玩家2: %2分").arg(score1).arg(score2);
+        result = QString("%1！平局！\n玩家1: %2分  玩家2: %3分").arg(reason).arg(score1).arg(score2);
     }
-    QMessageBox::information(this, "游戏结束", result);
-    close();
+    // 弹窗不阻塞事件循环，关闭弹窗后再关闭窗口
+    QMessageBox* box = new QMessageBox(QMessageBox::Information, "游戏结束", result, QMessageBox::Ok, this);
+    box->setAttribute(Qt::WA_DeleteOnClose);
+    connect(box, &QMessageBox::finished, this, &QWidget::close);
+    box->open();
 }
 
 // 游戏进度更新
@@ -230,28 +219,16 @@ void DuoMode::progress()
 {
     if (timeLeft > 0) {
         timeLeft--;
-        progressBar->setValue(timeLeft);
-        QString timeStr = QString::number(timeLeft) + "s";
-        progressBar->setFormat(timeStr);
-    }
-    if (timeLeft == 0) {
-        progressTimer->stop();
-        QString result;
-        if (score1 > score2) {
-            result = QString("时间到！玩家1获胜！\n玩家1: %1分  玩家2: %2分").arg(score1).arg(score2);
-        } else if (score2 > score1) {
-            result = QString("时间到！玩家2获胜！\n玩家1: %1分  玩家2: %2分").arg(score1).arg(score2);
-        } else {
-            result = QString("时间到！平局！\n玩家1: %1分  玩家2: %2分").arg(score1).arg(score2);
-        }
-        QMessageBox::information(this, "游戏结束", result);
-        close();
+        emit gameEvent(GameEvent::timeChanged(timeLeft));
+        autosave(false);
     }
+    if (timeLeft == 0) finishGame("时间到");
+    if (!finished && ++ticks % replayKeyframeInterval == 0) markKeyframe();
 }
 
 // 洗牌功能
 // 重新排列所有方块，打乱游戏布局
-void DuoMode::shuffle()
+void DuoMode::shuffle(quint32 seed)
 {
     QVector<Block*> nonEmptyBlocks;
     QVector<QPair<int, int>> positions;
@@ -263,11 +240,11 @@ void DuoMode::shuffle()
             }
         }
     }
-    std::shuffle(nonEmptyBlocks.begin(), nonEmptyBlocks.end(), *QRandomGenerator::global());
+    QVector<int> order = shufflePermutation(nonEmptyBlocks.size(), seed);
     for (int idx = 0; idx < positions.size(); ++idx) {
         int i = positions[idx].first;
         int j = positions[idx].second;
-        blocks[i][j] = nonEmptyBlocks[idx];
+        blocks[i][j] = nonEmptyBlocks[order[idx]];
         blocks[i][j]->setMapXY(j, i);
         blocks[i][j]->setCord(topX + j * blockWidth, topY + i * blockHeight);
     }
@@ -278,142 +255,368 @@ void DuoMode::initTextures()
 {
     QVector<int> allIds{1,2,3,4,5,6,7};
     std::shuffle(allIds.begin(), allIds.end(), *QRandomGenerator::global());
+    textures.setSpriteSize(blockWidth - 2 * spriteMargin, devicePixelRatioF());
     for (int i = 0; i < 3; ++i) {
         blockTextureIds[i] = allIds[i];
-        QString file = QString(":/images/images/%1-1.png").arg(blockTextureIds[i]);
-        blockPixmaps[i] = QPixmap(file).scaled(46, 46, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        for (int s = 0; s < 2; ++s) {
+            blockTextureFiles[i][s] = QString(":/images/images/%1-%2.png").arg(blockTextureIds[i]).arg(s + 1);
+            textures.pixmap(blockTextureFiles[i][s], Qt::FastTransformation); // 像素风贴图，预先解码并缩放
+        }
     }
     player1TextureFile = ":/images/images/player1.png";
     player2TextureFile = ":/images/images/player2.png";
-    player1Pixmap = QPixmap(player1TextureFile).scaled(46, 46, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    player2Pixmap = QPixmap(player2TextureFile).scaled(46, 46, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    textures.pixmap(player1TextureFile);
+    textures.pixmap(player2TextureFile);
+}
+
+// 按窗口尺寸重新计算布局
+// 以1200x800为基准等比缩放格子尺寸，游戏区水平居中
+// 贴图和背景图在此统一重新缩放一次，绘制时不再缩放
+void DuoMode::relayout()
+{
+    if (!score2Label) return; // 构造尚未完成
+    qreal scale = std::min(width() / 1200.0, height() / 800.0);
+    blockWidth = std::max(8, int(50 * scale));
+    blockHeight = blockWidth;
+    spriteMargin = std::max(1, blockWidth / 25);
+    topX = (width() - cols * blockWidth) / 2;
+    topY = qRound(80 * scale);
+    textures.setSpriteSize(blockWidth - 2 * spriteMargin, devicePixelRatioF());
+    background = scaledBackground(backgroundSource, size(), devicePixelRatioF());
+    if (tiledRender) updateTileSprites();
+
+    // 同步方块、玩家和道具的像素坐标
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (blocks[i][j])
+                blocks[i][j]->getCord() = QRectF(topX + j * blockWidth, topY + i * blockHeight, blockWidth, blockHeight);
+    QRectF& player1Rect = player1->getCord();
+    player1Rect = QRectF(topX + player1->getXInMap() * blockWidth, topY + player1->getYInMap() * blockHeight, blockWidth, blockHeight);
+    QRectF& player2Rect = player2->getCord();
+    player2Rect = QRectF(topX + player2->getXInMap() * blockWidth, topY + player2->getYInMap() * blockHeight, blockWidth, blockHeight);
+    for (Item& prop : props) {
+        QPoint pos = prop.getMapPos();
+        prop.setRect(QRectF(topX + pos.x() * blockWidth, topY + pos.y() * blockHeight, blockWidth, blockHeight));
+        prop.setPixmap(textures.pixmap(itemTextureFile(prop.getType())));
+    }
+
+    // 其余控件随窗口移动
+    progressBar->setGeometry(topX, qRound(20 * scale), cols * blockWidth, std::max(20, qRound(40 * scale)));
+    ui->exitBtn->move(width() - 230, 17);
+    ui->pauseBtn->move(width() - 116, 17);
+    score1Label->move(20, height() - 80);
+    score2Label->move(width() - 180, height() - 80);
+}
+
+// 窗口尺寸变化事件
+// event: 尺寸变化事件指针
+void DuoMode::resizeEvent(QResizeEvent* event)
+{
+    QMainWindow::resizeEvent(event);
+    relayout();
+}
+
+// 窗口状态变化事件
+// event: 状态变化事件指针
+// 窗口移到不同像素比的屏幕时重新缩放贴图
+void DuoMode::changeEvent(QEvent* event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::DevicePixelRatioChange && !qFuzzyCompare(textures.devicePixelRatio(), devicePixelRatioF()))
+        relayout();
+}
+
+// 将缩放好的方块贴图交给分块渲染器
+// 工作线程不能使用QPixmap，这里在GUI线程转换为QImage
+void DuoMode::updateTileSprites()
+{
+    QVector<QImage> sprites;
+    for (int form = 0; form < 3; ++form)
+        for (int state = 0; state < 2; ++state)
+            sprites.append(textures.pixmap(blockTextureFiles[form][state], Qt::FastTransformation).toImage());
+    tileRenderer.setSprites(blockWidth, spriteMargin, textures.devicePixelRatio(), sprites);
+}
+
+// 将棋盘压缩为每格一个字节
+// 返回按行存储的压缩数据，空位置视为已消除的空格
+QByteArray DuoMode::packedBoard() const
+{
+    QByteArray cells(rows * cols, 0);
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (blocks[i][j])
+                cells[i * cols + j] = char(packBlock(blocks[i][j]->getForm(), blocks[i][j]->getState()));
+    return cells;
+}
+
+// 重新压缩整个棋盘
+// 开局和整盘变化（读档、撤销、洗牌）之后调用，消除只改写两格
+void DuoMode::syncPackedCells()
+{
+    packedCells = packedBoard();
 }
 
 // 绘制消除路径
+// 每条路径随淡出动画逐渐变透明
 void DuoMode::drawLinkPath(QPainter& painter)
 {
-    if (linkPath.size() < 2) return;
-    QPen pen(QColor(160, 160, 160), 3);
-    painter.setPen(pen);
-    QVector<QPoint> pixelPoints;
-    for (const QPoint& pt : linkPath) {
-        int px = topX + pt.x() * blockWidth + blockWidth / 2;
-        int py = topY + pt.y() * blockHeight + blockHeight / 2;
-        pixelPoints.append(QPoint(px, py));
+    for (const Animation& anim : animations->animations()) {
+        if (!anim.active || anim.type != AnimationType::PathFade || anim.pointCount < 2) continue;
+        QColor color(160, 160, 160);
+        color.setAlphaF(float(1.0 - anim.progress));
+        painter.setPen(QPen(color, 3));
+        QPoint pixelPoints[4];
+        for (int k = 0; k < anim.pointCount; ++k) {
+            pixelPoints[k] = QPoint(topX + anim.points[k].x() * blockWidth + blockWidth / 2,
+                                    topY + anim.points[k].y() * blockHeight + blockHeight / 2);
+        }
+        painter.drawPolyline(pixelPoints, anim.pointCount);
+    }
+}
+
+// 绘制方块弹出动画
+// 被消除的方块以激活状态贴图放大并淡出
+void DuoMode::drawAnimations(QPainter& painter)
+{
+    for (const Animation& anim : animations->animations()) {
+        if (!anim.active || anim.type != AnimationType::BlockPop || anim.form < 0 || anim.form >= 3) continue;
+        const QPixmap& pix = textures.pixmap(blockTextureFiles[anim.form][1]);
+        QSizeF size = pix.deviceIndependentSize();
+        qreal scale = 1.0 + 0.4 * anim.progress;
+        painter.save();
+        painter.setOpacity(1.0 - anim.progress);
+        painter.translate(topX + (anim.points[0].x() + 0.5) * blockWidth, topY + (anim.points[0].y() + 0.5) * blockHeight);
+        painter.scale(scale, scale);
+        painter.drawPixmap(QPointF(-size.width() / 2, -size.height() / 2), pix);
+        painter.restore();
     }
-    painter.drawPolyline(pixelPoints.data(), pixelPoints.size());
 }
 
 // 生成道具（双人模式版本）
 void DuoMode::generateProp() {
-    QVector<QPoint> empty;
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j)
-            if (blocks[i][j] && blocks[i][j]->getState() == 0) {
-                bool isPlayerPosition = false;
-                if (player1 && j == player1->getXInMap() && i == player1->getYInMap()) {
-                    isPlayerPosition = true;
-                }
-                if (player2 && j == player2->getXInMap() && i == player2->getYInMap()) {
-                    isPlayerPosition = true;
-                }
-                if (isPlayerPosition) continue;
-                
-                bool occupied = false;
-                for (Item* prop : props)
-                    if (prop->isVisible() && prop->getMapPos() == QPoint(j, i)) { occupied = true; break; }
-                if (!occupied) empty.append(QPoint(j, i));
-            }
-    if (empty.isEmpty()) return;
-    QPoint pos = empty[QRandomGenerator::global()->bounded(empty.size())];
+    // 玩家所在的格子不生成道具，抽取前暂时移出空闲格集合
+    QPoint pos1 = player1 ? QPoint(player1->getXInMap(), player1->getYInMap()) : QPoint(-1, -1);
+    QPoint pos2 = player2 ? QPoint(player2->getXInMap(), player2->getYInMap()) : QPoint(-1, -1);
+    bool removed1 = freeCells.remove(pos1);
+    bool removed2 = freeCells.remove(pos2);
+    QPoint pos = freeCells.draw(rng);
+    if (removed1) freeCells.insert(pos1);
+    if (removed2) freeCells.insert(pos2);
+    if (pos.x() < 0) return;
     QRectF rect(topX + pos.x() * blockWidth, topY + pos.y() * blockHeight, blockWidth, blockHeight);
     
     QVector<ItemType> propTypes = {ItemType::AddTime, ItemType::Shuffle, ItemType::Hint, ItemType::Freeze, ItemType::Dizzy};
-    ItemType type = propTypes[QRandomGenerator::global()->bounded(propTypes.size())];
+    ItemType type = propTypes[rng.bounded(int(propTypes.size()))];
     
-    QPixmap pix;
-    switch (type) {
-        case ItemType::AddTime: pix = QPixmap(":/images/images/Time.png"); break;
-        case ItemType::Shuffle: pix = QPixmap(":/images/images/Shuffle.png"); break;
-        case ItemType::Hint:    pix = QPixmap(":/images/images/Hint.png"); break;
-        case ItemType::Freeze:  pix = QPixmap(":/images/images/Freeze.png"); break;
-        case ItemType::Dizzy:   pix = QPixmap(":/images/images/Dizzy.png"); break;
-        default: break;
-    }
-    Item* prop = new Item(type, pos, rect, pix);
-    props.append(prop);
+    props.add(type, pos, rect, textures.pixmap(itemTextureFile(type)));
+    emit gameEvent(GameEvent::propSpawned(pos, type));
+    if (Animation* spawn = animations->start(AnimationType::PropSpawn, 300)) {
+        spawn->points[0] = pos;
+        spawn->pointCount = 1;
+    }
     update();
 }
 
+// 重建空闲格集合
+// 开局、读档和洗牌后扫描整个棋盘，其余时候由状态变化增量维护
+void DuoMode::rebuildFreeCells() {
+    freeCells.reset(rows, cols);
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (blocks[i][j] && blocks[i][j]->getState() == 0) freeCells.insert(QPoint(j, i));
+    for (const Item& prop : props) freeCells.remove(prop.getMapPos());
+}
+
 // 绘制道具
+// 刚生成的道具随出现动画从小放大到原始尺寸
 void DuoMode::drawProps(QPainter& painter) {
-    for (Item* prop : props)
-        if (prop->isVisible())
-            prop->draw(painter);
+    for (const Item& prop : props) {
+        qreal scale = 1.0;
+        for (const Animation& anim : animations->animations())
+            if (anim.active && anim.type == AnimationType::PropSpawn && anim.points[0] == prop.getMapPos())
+                scale = 0.3 + 0.7 * anim.progress;
+        if (scale < 1.0) {
+            QPointF center = prop.getRect().center();
+            painter.save();
+            painter.translate(center.x(), center.y());
+            painter.scale(scale, scale);
+            painter.translate(-center.x(), -center.y());
+            prop.draw(painter);
+            painter.restore();
+        } else {
+            prop.draw(painter);
+        }
+    }
 }
 
 // paintEvent
 void DuoMode::paintEvent(QPaintEvent* event)
 {
     QPainter painter(this);
+    painter.drawPixmap(0, 0, background);
     painter.setBrush(QColor(147, 218, 100));
     painter.setPen(Qt::NoPen);
-    painter.drawRect(topX, topY, 700, 700);
+    painter.drawRect(topX, topY, cols * blockWidth, rows * blockHeight);
     
-    if (hintActive && hintBlock1 != QPoint(-1, -1) && hintBlock2 != QPoint(-1, -1)) {
+    if (effects.isActive(ItemType::Hint) && hintBlock1 != QPoint(-1, -1) && hintBlock2 != QPoint(-1, -1)) {
+        // Hint高亮随脉动动画明暗变化
+        qreal pulse = 0.5;
+        for (const Animation& anim : animations->animations())
+            if (anim.active && anim.type == AnimationType::HintPulse)
+                pulse = 0.5 - 0.5 * std::cos(anim.progress * 6.283185307);
         painter.setPen(QPen(Qt::red, 3));
-        painter.setBrush(QColor(255, 0, 0, 80));
+        painter.setBrush(QColor(255, 0, 0, 40 + int(80 * pulse)));
         QRectF r1(topX + hintBlock1.x() * blockWidth, topY + hintBlock1.y() * blockHeight, blockWidth, blockHeight);
         QRectF r2(topX + hintBlock2.x() * blockWidth, topY + hintBlock2.y() * blockHeight, blockWidth, blockHeight);
         painter.drawRect(r1);
         painter.drawRect(r2);
     }
     
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            Block* blk = blocks[i][j];
-            if (!blk) continue;
-            int state = blk->getState();
-            if (state == 0) continue;
-            int form = blk->getForm();
-            if (form < 0 || form >= 3) continue;
-            int texNum = blockTextureIds[form];
-            QString file = QString(":/images/images/%1-%2.png").arg(texNum).arg(state);
-            QPixmap pix(file);
-            if (pix.isNull()) pix = blockPixmaps[form];
-            painter.drawPixmap(topX + j * blockWidth + 2, topY + i * blockHeight + 2, 46, 46, pix);
+    if (tiledRender) {
+        // 分块并行渲染：只重绘内容变化的分块，再在GUI线程合成
+        tileRenderer.setBoard(rows, cols, packedBoard());
+        tileRenderer.render();
+        tileRenderer.composite(painter, QPoint(topX, topY));
+    } else {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                Block* blk = blocks[i][j];
+                if (!blk) continue;
+                int state = blk->getState();
+                if (state == 0) continue;
+                int form = blk->getForm();
+                if (form < 0 || form >= 3 || state > 2) continue;
+                // 贴图已按当前格子尺寸预先缩放，一比一绘制
+                painter.drawPixmap(topX + j * blockWidth + spriteMargin, topY + i * blockHeight + spriteMargin,
+                                   textures.pixmap(blockTextureFiles[form][state - 1]));
+            }
         }
     }
+    drawAnimations(painter);
     drawProps(painter);
-    QRectF player1Rect = player1->getCord();
-    QRectF player2Rect = player2->getCord();
-    painter.drawPixmap(player1Rect.x() + 2, player1Rect.y() + 2, 46, 46, player1Pixmap);
-    painter.drawPixmap(player2Rect.x() + 2, player2Rect.y() + 2, 46, 46, player2Pixmap);
+    QPointF player1Pos = playerDrawPos(1);
+    QPointF player2Pos = playerDrawPos(2);
+    painter.drawPixmap(QPointF(player1Pos.x() + spriteMargin, player1Pos.y() + spriteMargin), textures.pixmap(player1TextureFile));
+    painter.drawPixmap(QPointF(player2Pos.x() + spriteMargin, player2Pos.y() + spriteMargin), textures.pixmap(player2TextureFile));
     drawLinkPath(painter);
+    latency.frameFinished();
 }
 
 // 按键处理（双人模式）
 void DuoMode::keyPressEvent(QKeyEvent* event)
 {
-    if (event->key() == Qt::Key_W) handleMove(0, -1, 1);
-    else if (event->key() == Qt::Key_S) handleMove(0, 1, 1);
-    else if (event->key() == Qt::Key_A) handleMove(-1, 0, 1);
-    else if (event->key() == Qt::Key_D) handleMove(1, 0, 1);
-    else if (event->key() == Qt::Key_Up) handleMove(0, -1, 2);
-    else if (event->key() == Qt::Key_Down) handleMove(0, 1, 2);
-    else if (event->key() == Qt::Key_Left) handleMove(-1, 0, 2);
-    else if (event->key() == Qt::Key_Right) handleMove(1, 0, 2);
+    if (finished) return; // 对局结束后只等待关闭结束弹窗
+    // F5快速存档，F9快速读档，按住Shift使用第二个存档槽
+    // 存读档立即执行，执行前先完成已排队的输入，保持按键顺序
+    int quickSlot = event->modifiers() & Qt::ShiftModifier ? 1 : 0;
+    if ((event->key() == Qt::Key_F5 || event->key() == Qt::Key_F9) && simulation.hasPending()) simulate();
+    if (event->key() == Qt::Key_F5) { quickSave(quickSlot); return; }
+    if (event->key() == Qt::Key_F9) { quickLoad(quickSlot); return; }
+    // 方向键的重复由按键状态在每一步采样，忽略系统的自动重复
+    const int playerId = movePlayer(event->key());
+    if (playerId && event->isAutoRepeat()) return;
+    if (playerId) keys.press(event->key(), playerId, scheduler->now());
+    simulation.postKey(event->key(), latency.stamp());
+    scheduleStep();
+}
+
+// 松开按键事件
+void DuoMode::keyReleaseEvent(QKeyEvent* event)
+{
+    if (event->isAutoRepeat()) return;
+    keys.release(event->key(), scheduler->now());
+}
+
+// 窗口失去焦点事件
+// 之后收不到松开事件，清空按键状态，防止玩家一直移动
+void DuoMode::focusOutEvent(QFocusEvent* event)
+{
+    keys.releaseAll();
+    QMainWindow::focusOutEvent(event);
+}
+
+// 有输入排队或按住方向键时在下一个步边界安排一步模拟
+void DuoMode::scheduleStep() {
+    if (!scheduler->isScheduled(GameTimer::Step))
+        scheduler->schedule(GameTimer::Step, SimulationLoop::delayToNextStep(scheduler->now()));
+}
+
+// 执行一步模拟
+// 按到达顺序执行排队的输入并交给录制器，玩家换格时开始插值动画，最后只请求一次重绘
+void DuoMode::simulate() {
+    scheduler->cancel(GameTimer::Step);
+    const QPoint from1(player1->getXInMap(), player1->getYInMap());
+    const QPoint from2(player2->getXInMap(), player2->getYInMap());
+    for (const QueuedInput& input : simulation.take()) {
+        if (finished) break;
+        latency.inputReceived(input.stamp);
+        if (input.type == ReplayEventType::Key) {
+            recorder.recordKey(input.value);
+            handleKey(input.value);
+        } else {
+            recorder.recordClick(input.cell());
+            handleClick(input.cell().x(), input.cell().y());
+        }
+    }
+    // 两个玩家按住的方向键在同一步采样，重复移动与普通按键一样交给录制器
+    for (int key : keys.sample(scheduler->now())) {
+        if (finished) break;
+        recorder.recordKey(key);
+        handleKey(key);
+    }
+    const QPoint to1(player1->getXInMap(), player1->getYInMap());
+    const QPoint to2(player2->getXInMap(), player2->getYInMap());
+    if (to1 != from1 || to2 != from2) {
+        animations->stop(AnimationType::PlayerSlide);
+        for (int playerId : {1, 2}) {
+            const QPoint& from = playerId == 1 ? from1 : from2;
+            const QPoint& to = playerId == 1 ? to1 : to2;
+            if (to == from) continue;
+            if (Animation* slide = animations->start(AnimationType::PlayerSlide, simulationStep)) {
+                slide->points[0] = from;
+                slide->points[1] = to;
+                slide->pointCount = 2;
+                slide->form = playerId;
+            }
+        }
+    }
+    if (keys.isHeld() && !finished) scheduleStep(); // 按住方向键时每一步都要采样
+    update();
+}
+
+// 玩家的绘制位置
+// playerId: 玩家ID（1或2）
+// 插值动画播放时按显示帧的进度从上一格移向当前格，否则就是玩家所在的格子
+QPointF DuoMode::playerDrawPos(int playerId) {
+    for (const Animation& anim : animations->animations()) {
+        if (!anim.active || anim.type != AnimationType::PlayerSlide || anim.form != playerId) continue;
+        QPointF from(topX + anim.points[0].x() * blockWidth, topY + anim.points[0].y() * blockHeight);
+        QPointF to(topX + anim.points[1].x() * blockWidth, topY + anim.points[1].y() * blockHeight);
+        return from + (to - from) * anim.progress;
+    }
+    return (playerId == 1 ? player1 : player2)->getCord().topLeft();
+}
+
+// 处理按键
+// key: Qt::Key，WASD控制玩家1，方向键控制玩家2
+void DuoMode::handleKey(int key)
+{
+    if (key == Qt::Key_W) handleMove(0, -1, 1);
+    else if (key == Qt::Key_S) handleMove(0, 1, 1);
+    else if (key == Qt::Key_A) handleMove(-1, 0, 1);
+    else if (key == Qt::Key_D) handleMove(1, 0, 1);
+    else if (key == Qt::Key_Up) handleMove(0, -1, 2);
+    else if (key == Qt::Key_Down) handleMove(0, 1, 2);
+    else if (key == Qt::Key_Left) handleMove(-1, 0, 2);
+    else if (key == Qt::Key_Right) handleMove(1, 0, 2);
 }
 
 // 处理玩家移动（双人模式版本）
 void DuoMode::handleMove(int dx, int dy, int playerId) {
     Player* player = (playerId == 1) ? player1 : player2;
-    bool freezeActive = (playerId == 1) ? freezeActive1 : freezeActive2;
-    bool dizzyActive = (playerId == 1) ? dizzyActive1 : dizzyActive2;
-    
-    if (freezeActive) return;
+    if (effects.isActive(ItemType::Freeze, playerId)) return;
     
-    if (dizzyActive) {
+    if (effects.isActive(ItemType::Dizzy, playerId)) {
         dx = -dx;
         dy = -dy;
     }
@@ -435,7 +638,8 @@ void DuoMode::handleMove(int dx, int dy, int playerId) {
     player->setXInMap(nx);
     player->setYInMap(ny);
     player->getCord().moveTo(topX + nx * blockWidth, topY + ny * blockHeight);
-    checkPropCollision(playerId);
+    latency.classify(InputAction::Move);
+    emit gameEvent(GameEvent::playerMoved(playerId, QPoint(nx, ny)));
     update();
 }
 
@@ -443,6 +647,7 @@ void DuoMode::handleMove(int dx, int dy, int playerId) {
 void DuoMode::tryActivateBlock(int bx, int by, int playerId)
 {
     linkPath.clear();
+    latency.classify(InputAction::Activate);
     Block* blk = blocks[by][bx];
     Block*& activeBlock = (playerId == 1) ? activeBlock1 : activeBlock2;
     Player* player = (playerId == 1) ? player1 : player2;
@@ -458,9 +663,12 @@ void DuoMode::tryActivateBlock(int bx, int by, int playerId)
             player->setActive(false);
         } else {
             if (canEliminate(activeBlock, blk)) {
+                const QPoint cleared(activeBlock->getMapX(), activeBlock->getMapY());
                 player->setActive(false);
                 activeBlock = nullptr;
                 updateScore(2, playerId);
+                // 先计分再发出消除，游戏结束判定能看到这一对的得分
+                emit gameEvent(GameEvent::cellsCleared(cleared, QPoint(bx, by), playerId));
             } else {
                 activeBlock->setState(1);
                 blk->setState(2);
@@ -481,133 +689,56 @@ bool DuoMode::canEliminate(Block* block1, Block* block2) {
     int y2 = block2->getMapY();
     qDebug() << "canEliminate: block1 mapXY(" << x1 << "," << y1 << ") block2 mapXY(" << x2 << "," << y2 << ")";
     if (block1->getForm() == block2->getForm() && canLink(x1, y1, x2, y2, &linkPath)) {
-        block1->setState(0);
-        block2->setState(0);
-        
-        if (hintActive) {
-            if (!isHintPairValid()) {
-                findHintPair();
+        latency.classify(InputAction::Eliminate);
+        // 路径淡出，两个方块弹出后消失
+        if (Animation* fade = animations->start(AnimationType::PathFade, 400)) {
+            fade->pointCount = std::min(int(linkPath.size()), 4);
+            for (int k = 0; k < fade->pointCount; ++k) fade->points[k] = linkPath[k];
+        }
+        for (Block* blk : {block1, block2}) {
+            if (Animation* pop = animations->start(AnimationType::BlockPop, 250)) {
+                pop->points[0] = QPoint(blk->getMapX(), blk->getMapY());
+                pop->pointCount = 1;
+                pop->form = blk->getForm();
             }
         }
-        
+        block1->setState(0);
+        block2->setState(0);
+        // Hint更新和游戏结束判定由消除事件的订阅者完成
         update();
-        checkGameOver();
         return true;
     }
     return false;
 }
 
 // 判断直线是否可连
+// 规则见PackedBoard，游戏窗口和后台查找共用
 bool DuoMode::canLinkInLine(int x1, int y1, int x2, int y2)
 {
-    if (x1 == x2) {
-        if (std::abs(y1 - y2) == 1) return true;
-        for (int y = std::min(y1, y2) + 1; y < std::max(y1, y2); ++y) {
-            if (blocks[y][x1]->getState() != 0) {
-                return false;
-            }
-        }
-        return true;
-    } else if (y1 == y2) {
-        if (std::abs(x1 - x2) == 1) return true;
-        for (int x = std::min(x1, x2) + 1; x < std::max(x1, x2); ++x) {
-            if (blocks[y1][x]->getState() != 0) {
-                return false;
-            }
-        }
-        return true;
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLinkInLine(x1, y1, x2, y2);
 }
 
 // 判断1拐点是否可连
 bool DuoMode::canLinkWithOneCorner(int x1, int y1, int x2, int y2, QVector<QPoint>* path) {
-    if (blocks[y2][x1]->getState() == 0 &&
-        canLinkInLine(x1, y1, x1, y2) &&
-        canLinkInLine(x1, y2, x2, y2)) {
-        if (path) {
-            path->clear();
-            path->append(QPoint(x1, y1));
-            path->append(QPoint(x1, y2));
-            path->append(QPoint(x2, y2));
-        }
-        return true;
-    }
-    if (blocks[y1][x2]->getState() == 0 &&
-        canLinkInLine(x1, y1, x2, y1) &&
-        canLinkInLine(x2, y1, x2, y2)) {
-        if (path) {
-            path->clear();
-            path->append(QPoint(x1, y1));
-            path->append(QPoint(x2, y1));
-            path->append(QPoint(x2, y2));
-        }
-        return true;
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLinkWithOneCorner(x1, y1, x2, y2, path);
 }
 
 // 判断2拐点是否可连
 bool DuoMode::canLinkWithTwoCorners(int x1, int y1, int x2, int y2, QVector<QPoint>* path) {
-    for (int i = 0; i < rows; ++i) {
-        if (i == y1 || i == y2) continue;
-        if (blocks[i][x1]->getState() == 0 && blocks[i][x2]->getState() == 0 &&
-            canLinkInLine(x1, y1, x1, i) &&
-            canLinkInLine(x1, i, x2, i) &&
-            canLinkInLine(x2, i, x2, y2)) {
-            if (path) {
-                path->clear();
-                path->append(QPoint(x1, y1));
-                path->append(QPoint(x1, i));
-                path->append(QPoint(x2, i));
-                path->append(QPoint(x2, y2));
-            }
-            return true;
-        }
-    }
-    for (int j = 0; j < cols; ++j) {
-        if (j == x1 || j == x2) continue;
-        if (blocks[y1][j]->getState() == 0 && blocks[y2][j]->getState() == 0 &&
-            canLinkInLine(x1, y1, j, y1) &&
-            canLinkInLine(j, y1, j, y2) &&
-            canLinkInLine(j, y2, x2, y2)) {
-            if (path) {
-                path->clear();
-                path->append(QPoint(x1, y1));
-                path->append(QPoint(j, y1));
-                path->append(QPoint(j, y2));
-                path->append(QPoint(x2, y2));
-            }
-            return true;
-        }
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLinkWithTwoCorners(x1, y1, x2, y2, path);
 }
 
 // 判断是否可连通
 bool DuoMode::canLink(int x1, int y1, int x2, int y2, QVector<QPoint>* path) {
-    if (canLinkInLine(x1, y1, x2, y2)) {
-        if (path) {
-            path->clear();
-            path->append(QPoint(x1, y1));
-            path->append(QPoint(x2, y2));
-        }
-        return true;
-    }
-    if (canLinkWithOneCorner(x1, y1, x2, y2, path)) {
-        return true;
-    }
-    if (canLinkWithTwoCorners(x1, y1, x2, y2, path)) {
-        return true;
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLink(x1, y1, x2, y2, path);
 }
 
 // 退出按钮点击槽函数
 // 处理退出按钮点击事件
 void DuoMode::on_exitBtn_clicked()
 {
-    progressTimer->stop();
+    scheduler->clear();
+    autosaver.discard();
     emit exitToMenu();
     this->close();
 }
@@ -619,15 +750,11 @@ void DuoMode::on_pauseBtn_clicked() {
 // 暂停游戏
 // 暂停游戏并显示暂停菜单
 void DuoMode::pauseGame() {
-    if (isPaused) return;
+    if (isPaused || finished) return;
     isPaused = true;
-    if (progressTimer) progressTimer->stop();
-    if (propTimer) propTimer->stop();
-    if (hintTimer) hintTimer->stop();
-    if (freezeTimer1) freezeTimer1->stop();
-    if (freezeTimer2) freezeTimer2->stop();
-    if (dizzyTimer1) dizzyTimer1->stop();
-    if (dizzyTimer2) dizzyTimer2->stop();
+    keys.releaseAll(); // 暂停菜单接收按键，收不到松开事件
+    scheduler->pause(); // 游戏时钟停走，各定时事件保留剩余时间
+    autosave(true);
     setEnabled(false);
     pauseMenu = new PauseMenu(this);
     connect(pauseMenu, &PauseMenu::continueClicked, this, &DuoMode::onContinueBtnClicked);
@@ -641,13 +768,7 @@ void DuoMode::pauseGame() {
 // 恢复游戏状态，关闭暂停菜单
 void DuoMode::resumeGame() {
     isPaused = false;
-    if (progressTimer) progressTimer->start();
-    if (propTimer) propTimer->start();
-    if (hintTimer && hintActive) hintTimer->start();
-    if (freezeTimer1 && freezeActive1) freezeTimer1->start();
-    if (freezeTimer2 && freezeActive2) freezeTimer2->start();
-    if (dizzyTimer1 && dizzyActive1) dizzyTimer1->start();
-    if (dizzyTimer2 && dizzyActive2) dizzyTimer2->start();
+    scheduler->resume();
     setEnabled(true);
     if (pauseMenu) pauseMenu->close();
 }
@@ -656,21 +777,26 @@ void DuoMode::resumeGame() {
 void DuoMode::onContinueBtnClicked() { resumeGame(); }
 
 // 暂停菜单退出按钮点击槽函数
-void DuoMode::onExitBtnClicked() { if (pauseMenu) pauseMenu->close(); close(); }
+void DuoMode::onExitBtnClicked() { if (pauseMenu) pauseMenu->close(); autosaver.discard(); close(); }
 
 // 暂停菜单保存按钮点击槽函数
 void DuoMode::onSaveBtnClicked() {
-    QString path = QFileDialog::getSaveFileName(this, "保存存档", "", "存档文件 (*.txt)");
-    if (!path.isEmpty()) saveGame(path, getSaveData());
+    QString name = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".qsav";
+    QString path = QFileDialog::getSaveFileName(this, "保存存档", SaveLibrary::directory() + "/" + name, "存档文件 (*.qsav)");
+    if (!path.isEmpty()) SaveLibrary::instance()->save(path, getSaveData());
 }
 
 // 暂停菜单加载按钮点击槽函数
 void DuoMode::onLoadBtnClicked() {
-    QString path = QFileDialog::getOpenFileName(this, "读取存档", "", "存档文件 (*.txt)");
+    const GameMode mode = GameMode::Duo;
+    SaveBrowser browser(this, &mode);
+    QString path = browser.exec() == QDialog::Accepted ? browser.selectedPath() : QString();
     if (!path.isEmpty()) {
         SaveData data;
         if (loadGame(path, data) && data.mode == GameMode::Duo) {
             applySaveData(data);
+            recorder.cancel(); // 读档后的对局无法从种子复现
+            autosave(true);
             resumeGame();
             if (pauseMenu) pauseMenu->close();
         } else {
@@ -678,6 +804,15 @@ void DuoMode::onLoadBtnClicked() {
     }
 }
 
+// 自动存档
+// snapshot: true时写入完整快照并清空旧日志，false时只追加新增的日志记录
+void DuoMode::autosave(bool snapshot) {
+    QByteArray records = journal.takePending();
+    if (headless) return; // 重放不写自动存档
+    if (snapshot) autosaver.submit(getSaveData()); // 快照已包含这些记录的效果
+    else autosaver.append(records);
+}
+
 // 获取存档数据
 SaveData DuoMode::getSaveData() const {
     SaveData data;
@@ -688,60 +823,54 @@ SaveData DuoMode::getSaveData() const {
     data.player1Pos = QPoint(player1->getXInMap(), player1->getYInMap());
     data.player2Pos = QPoint(player2->getXInMap(), player2->getYInMap());
     data.blockTextureIds = blockTextureIds;
-    data.blockForms = QVector<QVector<int>>(rows, QVector<int>(cols));
-    data.blockStates = QVector<QVector<int>>(rows, QVector<int>(cols));
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j) {
-            data.blockForms[i][j] = blocks[i][j] ? blocks[i][j]->getForm() : -1;
-            data.blockStates[i][j] = blocks[i][j] ? blocks[i][j]->getState() : 0;
-        }
+    data.rows = rows;
+    data.cols = cols;
+    data.cells = packedBoard();
     data.propPositions.clear();
     data.propTypes.clear();
-    for (Item* prop : props) {
-        if (prop->isVisible()) {
-            data.propPositions.append(prop->getMapPos());
-            data.propTypes.append(static_cast<int>(prop->getType()));
-        }
+    for (const Item& prop : props) {
+        data.propPositions.append(prop.getMapPos());
+        data.propTypes.append(static_cast<int>(prop.getType()));
     }
     return data;
 }
 
 // 应用存档数据
 void DuoMode::applySaveData(const SaveData& data) {
-    timeLeft = data.timeLeft;
-    score1 = data.score1;
-    score2 = data.score2;
-    player1->setXInMap(data.player1Pos.x());
-    player1->setYInMap(data.player1Pos.y());
-    player1->getCord().moveTo(topX + data.player1Pos.x() * blockWidth, topY + data.player1Pos.y() * blockHeight);
-    player2->setXInMap(data.player2Pos.x());
-    player2->setYInMap(data.player2Pos.y());
-    player2->getCord().moveTo(topX + data.player2Pos.x() * blockWidth, topY + data.player2Pos.y() * blockHeight);
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j) {
-            if (blocks[i][j]) {
-                blocks[i][j]->setForm(data.blockForms[i][j]);
-                blocks[i][j]->setState(data.blockStates[i][j]);
-            }
+    applyBoardState(GameSnapshot::fromSaveData(data));
+}
+
+// 恢复快照中的棋盘、分数、时间、玩家和道具
+// snapshot: 局面快照
+// 压缩棋盘整块保存，只重写与当前局面不同的格子
+void DuoMode::applyBoardState(const GameSnapshot& snapshot) {
+    simulation.clear(); // 排队的输入针对读档前的局面，不再执行
+    scheduler->cancel(GameTimer::Step);
+    timeLeft = snapshot.timeLeft;
+    score1 = snapshot.score1;
+    score2 = snapshot.score2;
+    player1->setXInMap(snapshot.player1.x());
+    player1->setYInMap(snapshot.player1.y());
+    player1->getCord().moveTo(topX + snapshot.player1.x() * blockWidth, topY + snapshot.player1.y() * blockHeight);
+    player2->setXInMap(snapshot.player2.x());
+    player2->setYInMap(snapshot.player2.y());
+    player2->getCord().moveTo(topX + snapshot.player2.x() * blockWidth, topY + snapshot.player2.y() * blockHeight);
+    QByteArray current = packedBoard();
+    for (int i = 0; i < std::min(rows, snapshot.rows); ++i)
+        for (int j = 0; j < std::min(cols, snapshot.cols); ++j) {
+            char cell = snapshot.cells[i * snapshot.cols + j];
+            if (!blocks[i][j] || cell == current[i * cols + j]) continue;
+            // 压缩编码不保留已消除格子的形状
+            if (packedState(uchar(cell)) != 0) blocks[i][j]->setForm(packedForm(uchar(cell)));
+            blocks[i][j]->setState(packedState(uchar(cell)));
         }
-    for (Item* prop : props) delete prop;
     props.clear();
-    for (int i = 0; i < data.propPositions.size(); ++i) {
-        QRectF rect(topX + data.propPositions[i].x() * blockWidth, topY + data.propPositions[i].y() * blockHeight, blockWidth, blockHeight);
-        QPixmap pix;
-        ItemType type = static_cast<ItemType>(data.propTypes[i]);
-        switch (type) {
-            case ItemType::AddTime: pix = QPixmap(":/images/images/Time.png"); break;
-            case ItemType::Shuffle: pix = QPixmap(":/images/images/Shuffle.png"); break;
-            case ItemType::Hint:    pix = QPixmap(":/images/images/Hint.png"); break;
-            case ItemType::Freeze:  pix = QPixmap(":/images/images/Freeze.png"); break;
-            case ItemType::Dizzy:   pix = QPixmap(":/images/images/Dizzy.png"); break;
-            default: break;
-        }
-        Item* prop = new Item(type, data.propPositions[i], rect, pix);
-        props.append(prop);
+    for (int i = 0; i < snapshot.propPositions.size(); ++i) {
+        QRectF rect(topX + snapshot.propPositions[i].x() * blockWidth, topY + snapshot.propPositions[i].y() * blockHeight, blockWidth, blockHeight);
+        ItemType type = static_cast<ItemType>(snapshot.propTypes[i]);
+        props.add(type, snapshot.propPositions[i], rect, textures.pixmap(itemTextureFile(type)));
     }
-    updateScoreLabels();
+    emit gameEvent(GameEvent::boardReset(snapshot.player1, snapshot.player2, timeLeft));
     update();
 }
 
@@ -749,14 +878,14 @@ void DuoMode::applySaveData(const SaveData& data) {
 void DuoMode::checkPropCollision(int playerId) {
     Player* player = (playerId == 1) ? player1 : player2;
     QPoint playerPos(player->getXInMap(), player->getYInMap());
-    for (Item* prop : props) {
-        if (prop->isVisible()) {
-            if (prop->getMapPos() == playerPos) {
-                triggerPropEffect(prop->getType(), playerId);
-                prop->setVisible(false);
-            }
-        }
-    }
+    PropHandle handle = props.handleAt(playerPos);
+    Item* prop = props.get(handle);
+    if (!prop) return;
+    // 先回收再触发效果，洗牌等效果看到的是拾取后的局面
+    ItemType type = prop->getType();
+    props.remove(handle);
+    emit gameEvent(GameEvent::propCollected(playerId, playerPos, type));
+    triggerPropEffect(type, playerId);
 }
 
 // 触发道具效果（双人模式版本）
@@ -765,83 +894,107 @@ void DuoMode::triggerPropEffect(ItemType type, int playerId) {
         case ItemType::AddTime:
             timeLeft += 30;
             if (timeLeft > maxTime) timeLeft = maxTime;
-            progressBar->setValue(timeLeft);
-            break;
-        case ItemType::Shuffle:
-            shuffle();
+            emit gameEvent(GameEvent::timeChanged(timeLeft));
             break;
-        case ItemType::Hint:
-            hintActive = true;
-            findHintPair();
-            hintTimer->start(10000);
-            break;
-        case ItemType::Freeze:
-            if (playerId == 1) {
-                freezeActive2 = true;
-                freezeTimer2->start(3000);
-            } else {
-                freezeActive1 = true;
-                freezeTimer1->start(3000);
-            }
+        case ItemType::Shuffle: {
+            quint32 shuffleSeed = rng.generate();
+            shuffle(shuffleSeed);
+            emit gameEvent(GameEvent::shuffled(shuffleSeed));
             break;
-        case ItemType::Dizzy:
-            if (playerId == 1) {
-                dizzyActive2 = true;
-                dizzyTimer2->start(10000);
-            } else {
-                dizzyActive1 = true;
-                dizzyTimer1->start(10000);
-            }
+        }
+        default:
+            startEffect(type, playerId); // 冻结和眩晕作用于对手
             break;
-        default: break;
     }
     update();
 }
 
-// 检查当前高亮的Hint方块是否仍然有效
-bool DuoMode::isHintPairValid() {
-    if (hintBlock1 == QPoint(-1, -1) || hintBlock2 == QPoint(-1, -1)) return false;
-    
-    Block* b1 = blocks[hintBlock1.y()][hintBlock1.x()];
-    Block* b2 = blocks[hintBlock2.y()][hintBlock2.x()];
-    
-    if (!b1 || !b2 || b1->getState() == 0 || b2->getState() == 0) return false;
-    
-    return b1->getForm() == b2->getForm() && canLink(b1->getMapX(), b1->getMapY(), b2->getMapX(), b2->getMapY());
+// 同步查找Hint方块对
+// 无窗口重放时使用，有窗口时由后台线程查找
+void DuoMode::findHintPair() {
+    findLinkPair(packedCells, rows, cols, hintBlock1, hintBlock2);
 }
 
-// 查找可消除对用于Hint
-void DuoMode::findHintPair() {
-    for (int i = 2; i < rows-2; ++i) {
-        for (int j = 2; j < cols-2; ++j) {
-            Block* b1 = blocks[i][j];
-            if (!b1 || b1->getState() == 0) continue;
-            for (int ii = 2; ii < rows-2; ++ii) {
-                for (int jj = 2; jj < cols-2; ++jj) {
-                    if (i == ii && j == jj) continue;
-                    Block* b2 = blocks[ii][jj];
-                    if (!b2 || b2->getState() == 0) continue;
-                    if (b1->getForm() == b2->getForm() && canLink(b1->getMapX(), b1->getMapY(), b2->getMapX(), b2->getMapY())) {
-                        hintBlock1 = QPoint(j, i);
-                        hintBlock2 = QPoint(jj, ii);
-                        return;
-                    }
-                }
-            }
-        }
+// 棋盘变化后更新Hint方块对
+// 有窗口时把棋盘交给后台线程预先查找，Hint道具生效时直接读取结果；无窗口时只在需要显示时同步查找
+void DuoMode::updateHint() {
+    if (headless) {
+        if (effects.isActive(ItemType::Hint) && hintBlock1 == QPoint(-1, -1)) findHintPair();
+        return;
+    }
+    hintSolver.submit(packedCells, rows, cols);
+}
+
+// 后台查找完成
+// a, b: 可消除的方块对，没有时都为(-1,-1)
+// 没有可消除对说明棋盘成了死局，处理方式先交给录制器，重放时按记录执行，不依赖策略和查找时机
+void DuoMode::onHintSolved(const QPoint& a, const QPoint& b) {
+    if (a != QPoint(-1, -1)) {
+        showHint(a, b);
+        return;
+    }
+    if (finished) return;
+    const ReplayTick outcome = deadBoardOutcome();
+    recorder.recordTick(outcome);
+    resolveDeadBoard(outcome);
+}
+
+// 棋盘上是否已没有方块
+bool DuoMode::boardCleared() const {
+    for (int i = 2; i < rows - 2; ++i)
+        for (int j = 2; j < cols - 2; ++j)
+            if (blocks[i][j] && blocks[i][j]->getState() != 0) return false;
+    return true;
+}
+
+// 按策略决定死局的处理方式
+// 棋盘已清空、策略为直接结束或连续洗牌次数用完时结束对局，否则洗牌
+ReplayTick DuoMode::deadBoardOutcome() const {
+    if (boardCleared() || deadBoardPolicy == DeadBoardPolicy::End || deadShuffles >= deadBoardShuffleLimit)
+        return ReplayTick::DeadEnd;
+    return ReplayTick::DeadShuffle;
+}
+
+// 处理死局
+// outcome: DeadShuffle或DeadEnd
+// 洗牌后棋盘变化会重新提交查找，仍是死局时再次进入这里
+void DuoMode::resolveDeadBoard(ReplayTick outcome) {
+    if (outcome == ReplayTick::DeadEnd) {
+        finishGame("游戏结束");
+        return;
     }
-    hintBlock1 = QPoint(-1, -1);
-    hintBlock2 = QPoint(-1, -1);
+    ++deadShuffles;
+    quint32 shuffleSeed = rng.generate();
+    shuffle(shuffleSeed);
+    emit gameEvent(GameEvent::shuffled(shuffleSeed));
+    update();
+}
+
+// Hint生效时显示找到的方块对
+// a, b: 可消除的方块对
+// 没有显示中的方块对时才采用，仍然有效的方块对不会被替换
+void DuoMode::showHint(const QPoint& a, const QPoint& b) {
+    if (!effects.isActive(ItemType::Hint) || hintBlock1 != QPoint(-1, -1)) return;
+    hintBlock1 = a;
+    hintBlock2 = b;
+    update();
 }
 
 // 鼠标点击事件处理，支持Flash道具的瞬间移动功能（双人模式）
 void DuoMode::mousePressEvent(QMouseEvent* event) {
-    if (!flashActive1 && !flashActive2) return;
-    
+    if (finished) return;
+    if (!effects.isActive(ItemType::Flash, 1) && !effects.isActive(ItemType::Flash, 2)) return;
     QPoint pos = event->pos();
     int mx = (pos.x() - topX) / blockWidth;
     int my = (pos.y() - topY) / blockHeight;
-    
+    simulation.postClick(QPoint(mx, my), latency.stamp());
+    scheduleStep();
+}
+
+// 处理Flash道具下的点击
+// mx, my: 点击的地图坐标
+void DuoMode::handleClick(int mx, int my) {
+    if (!effects.isActive(ItemType::Flash, 1) && !effects.isActive(ItemType::Flash, 2)) return;
     if (mx < 0 || mx >= cols || my < 0 || my >= rows) return;
     
     if (mx == player2->getXInMap() && my == player2->getYInMap()) {
@@ -849,17 +1002,18 @@ void DuoMode::mousePressEvent(QMouseEvent* event) {
     }
     
     if (!blocks[my][mx] || blocks[my][mx]->getState() == 0) {
-        if (flashActive1) {
+        if (effects.isActive(ItemType::Flash, 1)) {
             player1->setXInMap(mx);
             player1->setYInMap(my);
             player1->getCord().moveTo(topX + mx * blockWidth, topY + my * blockHeight);
-            checkPropCollision(1);
-        } else if (flashActive2) {
+            emit gameEvent(GameEvent::playerMoved(1, QPoint(mx, my)));
+        } else if (effects.isActive(ItemType::Flash, 2)) {
             player2->setXInMap(mx);
             player2->setYInMap(my);
             player2->getCord().moveTo(topX + mx * blockWidth, topY + my * blockHeight);
-            checkPropCollision(2);
+            emit gameEvent(GameEvent::playerMoved(2, QPoint(mx, my)));
         }
+        latency.classify(InputAction::Move);
         update();
     } else {
         static const int dx[4] = {0, 0, -1, 1};
@@ -871,18 +1025,18 @@ void DuoMode::mousePressEvent(QMouseEvent* event) {
                 !(nx == player1->getXInMap() && ny == player1->getYInMap()) &&
                 !(nx == player2->getXInMap() && ny == player2->getYInMap())) {
                 
-                if (flashActive1) {
+                if (effects.isActive(ItemType::Flash, 1)) {
                     player1->setXInMap(nx);
                     player1->setYInMap(ny);
                     player1->getCord().moveTo(topX + nx * blockWidth, topY + ny * blockHeight);
                     tryActivateBlock(mx, my, 1);
-                    checkPropCollision(1);
-                } else if (flashActive2) {
+                    emit gameEvent(GameEvent::playerMoved(1, QPoint(nx, ny)));
+                } else if (effects.isActive(ItemType::Flash, 2)) {
                     player2->setXInMap(nx);
                     player2->setYInMap(ny);
                     player2->getCord().moveTo(topX + nx * blockWidth, topY + ny * blockHeight);
                     tryActivateBlock(mx, my, 2);
-                    checkPropCollision(2);
+                    emit gameEvent(GameEvent::playerMoved(2, QPoint(nx, ny)));
                 }
                 update();
                 break;
@@ -890,3 +1044,258 @@ void DuoMode::mousePressEvent(QMouseEvent* event) {
         }
     }
 }
+
+// 开始持续型道具效果
+// type: 道具类型
+// playerId: 拾取道具的玩家
+// 作用对象和持续时间查登记表，重放时不计时，由录制的结束事件结束
+void DuoMode::startEffect(ItemType type, int playerId) {
+    const EffectSpec* spec = effectSpec(type);
+    if (!spec || spec->target == EffectTarget::Instant) return;
+    const int target = spec->targetOf(playerId);
+    effects.apply(type, target, headless ? -1 : scheduler->now() + spec->duration);
+    armEffects();
+    if (type == ItemType::Hint) {
+        // 有窗口时直接读取后台预先算好的结果，还没算完时由送回的结果显示，没有提交过时现在提交
+        if (hintSolver.isReady()) showHint(hintSolver.first(), hintSolver.second());
+        else if (headless) findHintPair();
+        else if (!hintSolver.isPending()) updateHint();
+        animations->stop(AnimationType::HintPulse);
+        animations->start(AnimationType::HintPulse, 0);
+    }
+    emit gameEvent(GameEvent::effectStarted(target, type));
+}
+
+// 结束道具效果
+// type: 道具类型
+// playerId: 受影响的玩家，0表示整个棋盘
+// 叠加的同类记录一并结束
+void DuoMode::endEffect(ItemType type, int playerId) {
+    effects.end(type, playerId);
+    armEffects();
+    if (type == ItemType::Hint) {
+        hintBlock1 = QPoint(-1, -1);
+        hintBlock2 = QPoint(-1, -1);
+        animations->stop(AnimationType::HintPulse);
+    }
+    emit gameEvent(GameEvent::effectEnded(playerId, type));
+    update();
+}
+
+// 按最早到期的道具效果安排调度器
+void DuoMode::armEffects() {
+    const qint64 next = effects.nextExpiry();
+    if (next < 0) scheduler->cancel(GameTimer::Effect);
+    else scheduler->schedule(GameTimer::Effect, next - scheduler->now());
+}
+
+// 处理状态变化
+// event: 游戏逻辑发出的状态变化
+// 只做与这次变化有关的增量工作
+void DuoMode::onGameEvent(const GameEvent& event) {
+    switch (event.type) {
+        case GameEventType::ScoreChanged:
+            updateScoreLabels();
+            break;
+        case GameEventType::BoardReset:
+            syncPackedCells();
+            rebuildFreeCells();
+            hintBlock1 = hintBlock2 = QPoint(-1, -1);
+            updateHint();
+            updateScoreLabels();
+            break;
+        case GameEventType::TimeChanged:
+            progressBar->setValue(timeLeft);
+            progressBar->setFormat(QString::number(timeLeft) + "s");
+            break;
+        case GameEventType::PlayerMoved:
+            checkPropCollision(event.playerId);
+            break;
+        case GameEventType::CellsCleared:
+            for (const QPoint& cell : {event.a, event.b})
+                packedCells[cell.y() * cols + cell.x()] = char(packBlock(blocks[cell.y()][cell.x()]->getForm(), 0));
+            freeCells.insert(event.a);
+            freeCells.insert(event.b);
+            // 消除只会让路径更通畅，Hint方块对只有自身被消除时才失效
+            if (effects.isActive(ItemType::Hint) && (event.a == hintBlock1 || event.a == hintBlock2 || event.b == hintBlock1 || event.b == hintBlock2))
+                hintBlock1 = hintBlock2 = QPoint(-1, -1);
+            deadShuffles = 0;
+            updateHint();
+            break;
+        case GameEventType::Shuffled:
+            syncPackedCells();
+            rebuildFreeCells();
+            hintBlock1 = hintBlock2 = QPoint(-1, -1);
+            updateHint();
+            break;
+        case GameEventType::PropSpawned:
+            freeCells.remove(event.a);
+            break;
+        case GameEventType::PropCollected:
+            freeCells.insert(event.a);
+            break;
+        default:
+            break;
+    }
+}
+
+// 调度器事件分发
+// id: 触发的定时事件
+// 影响对局的事件先交给录制器，重放时按记录的顺序直接调用
+void DuoMode::onTimer(GameTimer id) {
+    switch (id) {
+        case GameTimer::Progress:
+            recorder.recordTick(ReplayTick::Progress);
+            progress();
+            break;
+        case GameTimer::Prop:
+            recorder.recordTick(ReplayTick::Prop);
+            generateProp();
+            break;
+        case GameTimer::Autosave:
+            autosave(true);
+            break;
+        case GameTimer::Step:
+            simulate();
+            break;
+        case GameTimer::Effect:
+            for (const StatusEffect& ended : effects.expire(scheduler->now())) {
+                recorder.recordTick(effectSpec(ended.type)->endTicks[ended.playerId]);
+                endEffect(ended.type, ended.playerId);
+            }
+            armEffects();
+            break;
+        default:
+            break;
+    }
+}
+
+// 执行一条重放事件
+// event: 录制的按键、点击或定时器事件
+// 对局结束后的事件不再执行，与有窗口时关闭后不再响应一致
+void DuoMode::applyReplayEvent(const ReplayEvent& event) {
+    if (finished) return;
+    switch (event.type) {
+        case ReplayEventType::Key:
+            handleKey(event.value);
+            break;
+        case ReplayEventType::Click:
+            handleClick(event.cell().x(), event.cell().y());
+            break;
+        case ReplayEventType::Tick: {
+            const ReplayTick tick = static_cast<ReplayTick>(event.value);
+            ItemType type;
+            int playerId;
+            if (tick == ReplayTick::Progress) progress();
+            else if (tick == ReplayTick::Prop) generateProp();
+            else if (tick == ReplayTick::DeadShuffle || tick == ReplayTick::DeadEnd) resolveDeadBoard(tick);
+            else if (effectForTick(tick, type, playerId)) endEffect(type, playerId);
+            break;
+        }
+    }
+}
+
+// 用新种子重置对局随机数
+// 重放从关键帧开始模拟时只需要这个种子，不必保存随机数的内部状态
+void DuoMode::markKeyframe() {
+    keyframeSeed = rng.generate();
+    rng.seed(keyframeSeed);
+    if (recorder.isRecording()) recorder.recordKeyframe(captureKeyframe());
+}
+
+// 保存当前局面快照
+GameSnapshot DuoMode::captureSnapshot() const {
+    GameSnapshot snapshot;
+    snapshot.rows = rows;
+    snapshot.cols = cols;
+    snapshot.cells = packedBoard();
+    snapshot.timeLeft = timeLeft;
+    snapshot.score1 = score1;
+    snapshot.score2 = score2;
+    snapshot.player1 = QPoint(player1->getXInMap(), player1->getYInMap());
+    snapshot.player2 = QPoint(player2->getXInMap(), player2->getYInMap());
+    for (const Item& prop : props) {
+        snapshot.propPositions.append(prop.getMapPos());
+        snapshot.propTypes.append(static_cast<int>(prop.getType()));
+    }
+    snapshot.flags = effects.keyframeFlags();
+    snapshot.effects = effects.save(scheduler->now());
+    snapshot.timers = scheduler->save();
+    if (activeBlock1) snapshot.active1 = QPoint(activeBlock1->getMapX(), activeBlock1->getMapY());
+    if (activeBlock2) snapshot.active2 = QPoint(activeBlock2->getMapX(), activeBlock2->getMapY());
+    return snapshot;
+}
+
+// 恢复局面快照
+// snapshot: captureSnapshot保存的局面
+// 有窗口时道具效果、倒计时和道具生成都按快照中的剩余时间继续计时
+void DuoMode::restoreSnapshot(const GameSnapshot& snapshot) {
+    applyBoardState(snapshot);
+    finished = false;
+    linkPath.clear();
+    // 关键帧没有定时事件记录，重放由录制的事件驱动，不改动调度器
+    if (!headless && !snapshot.timers.isEmpty()) {
+        scheduler->restore(snapshot.timers);
+        scheduler->cancel(GameTimer::Step); // 排队的输入已清空
+    }
+    // 关键帧没有效果记录，按标志以完整时长计时
+    effects.restore(snapshot.effects, snapshot.flags, scheduler->now(), !headless);
+    armEffects();
+    hintBlock1 = hintBlock2 = QPoint(-1, -1);
+    updateHint();
+    auto blockAt = [this](const QPoint& pos) -> Block* {
+        return pos.x() >= 0 && pos.x() < cols && pos.y() >= 0 && pos.y() < rows ? blocks[pos.y()][pos.x()] : nullptr;
+    };
+    activeBlock1 = blockAt(snapshot.active1);
+    activeBlock2 = blockAt(snapshot.active2);
+    player1->setActive(activeBlock1 != nullptr);
+    player2->setActive(activeBlock2 != nullptr);
+    progressBar->setValue(timeLeft);
+    progressBar->setFormat(QString::number(timeLeft) + "s");
+    update();
+}
+
+// 保存当前状态为关键帧
+ReplayKeyframe DuoMode::captureKeyframe() const {
+    ReplayKeyframe keyframe;
+    keyframe.seed = keyframeSeed;
+    keyframe.ticks = ticks;
+    keyframe.flags = effects.keyframeFlags();
+    if (activeBlock1) keyframe.active1 = QPoint(activeBlock1->getMapX(), activeBlock1->getMapY());
+    if (activeBlock2) keyframe.active2 = QPoint(activeBlock2->getMapX(), activeBlock2->getMapY());
+    keyframe.state = encodeSave(getSaveData());
+    return keyframe;
+}
+
+// 恢复到关键帧
+// keyframe: captureKeyframe保存的状态
+void DuoMode::restoreKeyframe(const ReplayKeyframe& keyframe) {
+    SaveData data;
+    if (!decodeSave(keyframe.state, data)) return;
+    GameSnapshot snapshot = GameSnapshot::fromSaveData(data);
+    snapshot.flags = keyframe.flags;
+    snapshot.active1 = keyframe.active1;
+    snapshot.active2 = keyframe.active2;
+    restoreSnapshot(snapshot);
+    rng.seed(keyframe.seed);
+    keyframeSeed = keyframe.seed;
+    ticks = keyframe.ticks;
+}
+
+// 快速存档
+// slot: 存档槽编号
+void DuoMode::quickSave(int slot) {
+    quickSlots.store(slot, captureSnapshot());
+    if (quickSlots.isMirrored()) quickSlots.mirror(slot, getSaveData());
+}
+
+// 快速读档
+// slot: 存档槽编号，槽为空时不做任何事
+void DuoMode::quickLoad(int slot) {
+    if (finished) return; // 读档会清除结束标志，结束后不再允许
+    const GameSnapshot* snapshot = quickSlots.snapshot(slot);
+    if (!snapshot) return;
+    restoreSnapshot(*snapshot);
+    recorder.cancel(); // 读档后的对局无法从种子复现
+    autosave(true);
+}
@@ -5,7 +5,6 @@
 #include <QString>
 #include <QPixmap>
 #include <QProgressBar>
-#include <QTimer>
 #include <QVector>
 #include <QPoint>
 #include <QLabel>
@@ -27,6 +26,23 @@
 #include "item.h"
 #include "load.h"
 #include "pausemenu.h"
+#include "texturecache.h"
+#include "tilerenderer.h"
+#include "animationdriver.h"
+#include "latencyprobe.h"
+#include "autosaver.h"
+#include "movejournal.h"
+#include "replay.h"
+#include "quicksave.h"
+#include "gamescheduler.h"
+#include "simulationloop.h"
+#include "keyrepeat.h"
+#include "gameevent.h"
+#include "freecellset.h"
+#include "proppool.h"
+#include "effectsystem.h"
+#include "hintsolver.h"
+#include "boardpipeline.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class DuoModeClass; }
@@ -41,19 +57,27 @@ class DuoMode : public QMainWindow
 public:
     // 声明测试类为友元类
     friend class SimpleTest;
+    // 声明重放器为友元类
+    friend class Replayer;
     // 构造函数
     // parent: 父窗口指针，默认为nullptr
     // saveData: 存档数据指针，用于加载游戏状态，默认为nullptr
+    // seed: 对局随机种子，决定初始棋盘、道具和洗牌，默认随机生成
+    // headless: 无窗口重放时为true，不启动定时器、不自动存档、结束时不弹窗
+    // board: 后台预先发好的开局棋盘，种子和尺寸与本局一致时直接使用，否则按种子当场发牌
     // 初始化双人模式游戏窗口，设置游戏界面和逻辑
-    DuoMode(QWidget *parent = nullptr, const SaveData* saveData = nullptr);
+    DuoMode(QWidget *parent = nullptr, const SaveData* saveData = nullptr,
+            quint32 seed = QRandomGenerator::global()->generate(), bool headless = false,
+            const PreparedBoard* board = nullptr);
     
     // 析构函数
     // 清理游戏资源，停止定时器，删除动态分配的对象
     ~DuoMode();
     
     // 打乱功能
+    // seed: 随机种子，相同种子得到相同布局，便于日志重放
     // 重新排列所有方块，打乱游戏布局
-    void shuffle();
+    void shuffle(quint32 seed);
     
     // 游戏进度更新
     // 更新游戏状态，包括时间、分数等
@@ -68,6 +92,11 @@ signals:
     // 当游戏时间用完时发出
     void timeOut();
     
+    // 对局状态变化信号
+    // event: 消除、移动、道具、效果、分数和时间的变化
+    // 自动存档日志和界面都订阅这个信号，只处理变化的部分
+    void gameEvent(const GameEvent& event);
+    
     // 退出到主菜单信号
     // 当玩家选择退出游戏时发出
     void exitToMenu();
@@ -117,23 +146,64 @@ private slots:
 
 private:
     Ui::DuoModeClass *ui;              // UI界面指针，管理游戏界面的所有控件
+    quint32 seed;                      // 对局随机种子
+    QRandomGenerator rng;              // 对局随机数，只用于影响对局的随机事件，重放时按种子复现
+    FreeCellSet freeCells;             // 没有方块也没有道具的空格，生成道具时从中抽取
+    bool headless = false;             // 是否为无窗口重放
+    bool finished = false;             // 对局是否已结束
+    ReplayRecorder recorder;           // 对局录制器
+    void finishGame(const QString& reason); // 结束对局：停止计时、保存录像，有窗口时弹窗判定胜负并关闭
+    void handleKey(int key);           // 处理按键，键盘事件和重放共用
+    void handleClick(int mx, int my);  // 处理Flash道具下点击地图坐标(mx,my)，鼠标事件和重放共用
+    void startEffect(ItemType type, int playerId); // 按登记表开始玩家playerId拾取的持续型道具效果
+    void endEffect(ItemType type, int playerId);   // 结束道具效果，playerId为受影响的玩家，0表示整个棋盘
+    void armEffects();                 // 按最早到期的道具效果安排调度器
+    void applyReplayEvent(const ReplayEvent& event); // 执行一条重放事件
+    int ticks = 0;                     // 已经过的倒计时次数
+    quint32 keyframeSeed = 0;          // 最近一次关键帧重置的随机种子
+    void markKeyframe();               // 用新种子重置对局随机数，录制时保存关键帧
+    GameSnapshot captureSnapshot() const; // 保存当前局面快照，关键帧和快速存档共用
+    void restoreSnapshot(const GameSnapshot& snapshot); // 恢复局面快照
+    void applyBoardState(const GameSnapshot& snapshot); // 恢复快照中的棋盘、分数、时间、玩家和道具
+    ReplayKeyframe captureKeyframe() const; // 保存当前状态为关键帧
+    void restoreKeyframe(const ReplayKeyframe& keyframe); // 恢复到关键帧
+    QuickSlots quickSlots{GameMode::Duo}; // 内存中的快速存档槽
+    void quickSave(int slot);          // 快速存档（F5）
+    void quickLoad(int slot);          // 快速读档（F9）
     QProgressBar* progressBar = nullptr; // 进度条控件，显示剩余时间
-    QTimer* progressTimer = nullptr;     // 进度定时器，控制游戏时间
+    GameScheduler* scheduler = nullptr;  // 游戏调度器：倒计时、道具生成、自动存档和道具效果按游戏时间触发
+    void onTimer(GameTimer id);          // 调度器事件分发
+    void onGameEvent(const GameEvent& event); // 处理状态变化：刷新分数和时间显示、检测道具碰撞、更新Hint、判定游戏结束
+    SimulationLoop simulation;           // 固定步长模拟循环，键盘和鼠标输入排队到下一步执行
+    void scheduleStep();                 // 有输入排队或按住方向键时安排下一步模拟
+    KeyRepeat keys = KeyRepeat::fromEnvironment(); // 两个玩家的按键状态，按住方向键时按步重复移动
+    void simulate();                     // 执行一步模拟
+    QPointF playerDrawPos(int playerId); // 玩家的绘制位置，两步之间插值
     Player* player1 = nullptr;           // 玩家1对象指针
     Player* player2 = nullptr;           // 玩家2对象指针
     QVector<QVector<Block*>> blocks;     // 14x14游戏地图，blocks[y][x]，(2,2)-(11,11)为游戏区，其余为state=0
-    int rows = 14, cols = 14;            // 地图行数和列数
+    int rows = boardRows, cols = boardCols; // 地图行数和列数
     int maxTime = 120;                   // 游戏最大时间（秒）
     int timeLeft = maxTime;              // 剩余时间（秒）
-    int formNum = 3;                     // 方块形状种类数量
+    int formNum = boardForms;            // 方块形状种类数量
     int topX = 250, topY = 80;           // 游戏区域左上角坐标
     int blockWidth = 50, blockHeight = 50; // 方块宽度和高度（像素）
     bool timeFlag = true;                // 时间标志，控制时间是否继续计时
     std::array<int, 3> blockTextureIds;  // 本局使用的三个方块贴图编号（1-7）
     QString player1TextureFile, player2TextureFile; // 玩家1和玩家2贴图文件名
-    std::array<QPixmap, 3> blockPixmaps; // 三个方块贴图
-    QPixmap player1Pixmap, player2Pixmap; // 玩家1和玩家2贴图
+    std::array<std::array<QString, 2>, 3> blockTextureFiles; // 三种方块未激活/激活状态的贴图文件名
+    TextureCache textures;               // 按格子尺寸预缩放的贴图缓存
+    int spriteMargin = 2;                // 贴图与格子边缘的间距（像素）
+    QPixmap backgroundSource;            // 原始背景图，只解码一次
+    QPixmap background;                  // 按窗口尺寸缩放后的背景图，每帧直接贴图
     void initTextures();                 // 初始化贴图资源
+    void relayout();                     // 按窗口尺寸重新计算格子尺寸和布局
+    TileRenderer tileRenderer;           // 超大棋盘使用的分块并行渲染器
+    bool tiledRender = false;            // 是否启用分块并行渲染
+    void updateTileSprites();            // 将缩放好的方块贴图交给分块渲染器
+    QByteArray packedBoard() const;      // 将棋盘压缩为每格一个字节，按行存储
+    QByteArray packedCells;              // 压缩棋盘缓存，随消除、洗牌和整盘重置事件更新，连线判定和后台查找共用
+    void syncPackedCells();              // 从方块重新生成压缩棋盘缓存
     Block* activeBlock1 = nullptr;       // 玩家1当前激活的方块
     Block* activeBlock2 = nullptr;       // 玩家2当前激活的方块
     void handleMove(int dx, int dy, int playerId); // 处理玩家移动
@@ -144,33 +214,35 @@ private:
     bool canLinkWithOneCorner(int x1, int y1, int x2, int y2, QVector<QPoint>* path = nullptr); // 判断一拐点连接
     bool canLinkWithTwoCorners(int x1, int y1, int x2, int y2, QVector<QPoint>* path = nullptr); // 判断两拐点连接
     QVector<QPoint> linkPath;            // 存储当前需要高亮的消除路径
-    void drawLinkPath(QPainter& painter); // 绘制消除路径
+    void drawLinkPath(QPainter& painter); // 绘制淡出中的消除路径
+    AnimationDriver* animations = nullptr; // 动画驱动器，统一推进路径淡出、方块弹出、Hint脉动和道具出现动画
+    void drawAnimations(QPainter& painter); // 绘制方块弹出动画
+    LatencyProbe latency;                // 输入到绘制完成的延迟统计
     int score1 = 0, score2 = 0;          // 玩家1和玩家2的分数
     QLabel* score1Label = nullptr;       // 玩家1分数显示控件
     QLabel* score2Label = nullptr;       // 玩家2分数显示控件
     void updateScore(int delta, int playerId); // 更新分数
     void updateScoreLabels();            // 刷新分数显示
-    void checkGameOver();                // 检查游戏是否结束
-    QVector<Item*> props;                // 道具容器
-    QTimer* propTimer = nullptr;         // 道具生成定时器
-    QTimer* hintTimer = nullptr;         // Hint道具计时器
-    QTimer* freezeTimer1 = nullptr;      // 玩家1冻结计时器
-    QTimer* freezeTimer2 = nullptr;      // 玩家2冻结计时器
-    QTimer* dizzyTimer1 = nullptr;       // 玩家1眩晕计时器
-    QTimer* dizzyTimer2 = nullptr;       // 玩家2眩晕计时器
-    bool freezeActive1 = false;          // 玩家1冻结标志
-    bool freezeActive2 = false;          // 玩家2冻结标志
-    bool dizzyActive1 = false;           // 玩家1眩晕标志
-    bool dizzyActive2 = false;           // 玩家2眩晕标志
-    bool flashActive1 = false;           // 玩家1 Flash道具激活标志
-    bool flashActive2 = false;           // 玩家2 Flash道具激活标志
+    bool boardCleared() const;           // 棋盘上是否已没有方块
+    ReplayTick deadBoardOutcome() const; // 按策略决定死局的处理方式
+    void resolveDeadBoard(ReplayTick outcome); // 处理死局：自动洗牌或结束对局
+    DeadBoardPolicy deadBoardPolicy = deadBoardPolicyFromEnvironment(); // 死局处理策略
+    int deadShuffles = 0;                // 连续自动洗牌的次数
+    PropPool props;                      // 场上的道具，按格子索引
+    MoveJournal journal;                 // 本局的状态变化日志
+    void autosave(bool snapshot);        // 自动存档：写完整快照，或只追加新增的日志记录
+    AutoSaver autosaver{AutoSaver::pathFor(GameMode::Duo)}; // 后台自动存档器
+    EffectSystem effects;                // 生效中的道具效果
+    HintSolver hintSolver;               // 后台查找Hint方块对
     void generateProp();                 // 生成道具
+    void rebuildFreeCells();             // 扫描棋盘重建空闲格集合
     void checkPropCollision(int playerId); // 检查玩家与道具碰撞
     void drawProps(QPainter& painter);   // 绘制道具
     void triggerPropEffect(ItemType type, int playerId); // 触发道具效果
-    bool isHintPairValid();              // 检查当前Hint方块对是否有效
-    void findHintPair();                 // 查找可消除对用于Hint
-    bool hintActive = false;             // Hint道具激活标志
+    void findHintPair();                 // 同步查找可消除对用于Hint
+    void updateHint();                   // 棋盘变化后更新Hint方块对
+    void onHintSolved(const QPoint& a, const QPoint& b); // 后台查找完成，死局时按策略处理
+    void showHint(const QPoint& a, const QPoint& b); // Hint生效时显示找到的方块对
     QPoint hintBlock1, hintBlock2;       // Hint高亮的两个方块
 
 protected:
@@ -179,11 +251,31 @@ protected:
     // 处理窗口绘制，包括方块、玩家、道具、路径等的绘制
     void paintEvent(QPaintEvent* event) override;
     
+    // 重写窗口尺寸变化事件
+    // event: 尺寸变化事件指针
+    // 按新的窗口尺寸重新计算格子尺寸，并重新缩放贴图缓存
+    void resizeEvent(QResizeEvent* event) override;
+
+    // 重写窗口状态变化事件
+    // event: 状态变化事件指针
+    // 设备像素比变化时重新计算布局并重新缩放贴图，绘制事件只负责绘制
+    void changeEvent(QEvent* event) override;
+    
     // 重写按键事件
     // event: 按键事件指针
     // 处理WASD按键（玩家1）和方向键（玩家2），控制玩家移动
     void keyPressEvent(QKeyEvent* event) override;
     
+    // 重写松开按键事件
+    // event: 按键事件指针
+    // 更新按键状态，松开后停止该方向的重复移动
+    void keyReleaseEvent(QKeyEvent* event) override;
+    
+    // 重写失去焦点事件
+    // event: 焦点事件指针
+    // 清空按键状态
+    void focusOutEvent(QFocusEvent* event) override;
+    
     // 重写鼠标点击事件
     // event: 鼠标事件指针
     // 支持Flash道具的鼠标点击移动功能
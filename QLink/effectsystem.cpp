@@ -0,0 +1,158 @@
+#include "effectsystem.h"
+#include <algorithm>
+
+// 道具效果登记表
+static const EffectSpec effectSpecs[] = {
+    {ItemType::AddTime, EffectTarget::Instant, 0, {}, {}},
+    {ItemType::Shuffle, EffectTarget::Instant, 0, {}, {}},
+    {ItemType::Hint, EffectTarget::Board, 10000,
+     {ReplayTick::HintEnd, ReplayTick::HintEnd, ReplayTick::HintEnd}, {KeyframeHint, 0, 0}},
+    {ItemType::Flash, EffectTarget::Self, 5000,
+     {ReplayTick::FlashEnd, ReplayTick::FlashEnd, ReplayTick::Flash2End}, {0, KeyframeFlash1, KeyframeFlash2}},
+    {ItemType::Freeze, EffectTarget::Opponent, 3000,
+     {ReplayTick::Freeze1End, ReplayTick::Freeze1End, ReplayTick::Freeze2End}, {0, KeyframeFreeze1, KeyframeFreeze2}},
+    {ItemType::Dizzy, EffectTarget::Opponent, 10000,
+     {ReplayTick::Dizzy1End, ReplayTick::Dizzy1End, ReplayTick::Dizzy2End}, {0, KeyframeDizzy1, KeyframeDizzy2}},
+};
+
+// 受影响的玩家
+int EffectSpec::targetOf(int collector) const
+{
+    switch (target) {
+        case EffectTarget::Self: return collector;
+        case EffectTarget::Opponent: return 3 - collector;
+        default: return 0;
+    }
+}
+
+// 查找道具的效果登记
+const EffectSpec* effectSpec(ItemType type)
+{
+    for (const EffectSpec& spec : effectSpecs)
+        if (spec.type == type) return &spec;
+    return nullptr;
+}
+
+// 查找重放的结束事件对应的效果
+// 整个棋盘的效果只用下标0，玩家的效果只用下标1和2
+bool effectForTick(ReplayTick tick, ItemType& type, int& playerId)
+{
+    for (const EffectSpec& spec : effectSpecs) {
+        if (spec.target == EffectTarget::Instant) continue;
+        const int first = spec.target == EffectTarget::Board ? 0 : 1;
+        const int last = spec.target == EffectTarget::Board ? 0 : 2;
+        for (int player = first; player <= last; ++player) {
+            if (spec.endTicks[player] == tick) {
+                type = spec.type;
+                playerId = player;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 施加效果
+bool EffectSystem::apply(ItemType type, int playerId, qint64 expiry)
+{
+    bool started = !isActive(type, playerId);
+    records.append(StatusEffect{type, quint8(playerId), expiry});
+    return started;
+}
+
+// 结束效果
+bool EffectSystem::end(ItemType type, int playerId)
+{
+    int kept = 0;
+    for (int i = 0; i < records.size(); ++i)
+        if (records[i].type != type || records[i].playerId != playerId) records[kept++] = records[i];
+    bool removed = kept < records.size();
+    records.resize(kept);
+    return removed;
+}
+
+// 效果是否生效中
+bool EffectSystem::isActive(ItemType type, int playerId) const
+{
+    for (const StatusEffect& effect : records)
+        if (effect.type == type && effect.playerId == playerId) return true;
+    return false;
+}
+
+// 同类效果叠加的记录数
+int EffectSystem::stacks(ItemType type, int playerId) const
+{
+    int count = 0;
+    for (const StatusEffect& effect : records)
+        if (effect.type == type && effect.playerId == playerId) ++count;
+    return count;
+}
+
+// 移除到期的记录
+// 同时到期时按道具类型和玩家排序，保证结束顺序确定
+QVector<StatusEffect> EffectSystem::expire(qint64 now)
+{
+    QVector<StatusEffect> due;
+    int kept = 0;
+    for (int i = 0; i < records.size(); ++i) {
+        if (records[i].expiry >= 0 && records[i].expiry <= now) due.append(records[i]);
+        else records[kept++] = records[i];
+    }
+    records.resize(kept);
+    std::sort(due.begin(), due.end(), [](const StatusEffect& a, const StatusEffect& b) {
+        if (a.expiry != b.expiry) return a.expiry < b.expiry;
+        if (a.type != b.type) return a.type < b.type;
+        return a.playerId < b.playerId;
+    });
+    QVector<StatusEffect> ended;
+    for (const StatusEffect& effect : due) {
+        if (isActive(effect.type, effect.playerId)) continue; // 还有叠加的记录
+        bool duplicate = false;
+        for (const StatusEffect& other : ended)
+            if (other.type == effect.type && other.playerId == effect.playerId) duplicate = true;
+        if (!duplicate) ended.append(effect);
+    }
+    return ended;
+}
+
+// 最早的到期时间
+qint64 EffectSystem::nextExpiry() const
+{
+    qint64 next = -1;
+    for (const StatusEffect& effect : records)
+        if (effect.expiry >= 0 && (next < 0 || effect.expiry < next)) next = effect.expiry;
+    return next;
+}
+
+// 生效中的效果对应的关键帧标志
+quint32 EffectSystem::keyframeFlags() const
+{
+    quint32 flags = 0;
+    for (const StatusEffect& effect : records)
+        if (const EffectSpec* spec = effectSpec(effect.type)) flags |= spec->keyframeFlags[effect.playerId];
+    return flags;
+}
+
+// 保存所有记录
+QVector<StatusEffect> EffectSystem::save(qint64 now) const
+{
+    QVector<StatusEffect> saved = records;
+    for (StatusEffect& effect : saved)
+        if (effect.expiry >= 0) effect.expiry = std::max<qint64>(0, effect.expiry - now);
+    return saved;
+}
+
+// 恢复保存的记录
+// 关键帧只记录了哪些效果生效，这些效果按完整时长重新计时
+void EffectSystem::restore(const QVector<StatusEffect>& saved, quint32 flags, qint64 now, bool timed)
+{
+    records.clear();
+    for (StatusEffect effect : saved) {
+        effect.expiry = timed && effect.expiry >= 0 ? now + effect.expiry : -1;
+        records.append(effect);
+    }
+    for (const EffectSpec& spec : effectSpecs)
+        for (int player = 0; player < 3; ++player)
+            if ((flags & spec.keyframeFlags[player]) && !isActive(spec.type, player))
+                apply(spec.type, player, timed ? now + spec.duration : -1);
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <QVector>
+#include "item.h"
+#include "replay.h"
+
+// 道具效果的作用对象
+enum class EffectTarget : quint8 {
+    Instant,   // 拾取时立即生效，没有持续时间
+    Board,     // 作用于整个棋盘
+    Self,      // 作用于拾取道具的玩家
+    Opponent   // 作用于对手
+};
+
+// 道具效果登记表中的一项
+// 数组按受影响的玩家编号索引，0表示整个棋盘
+struct EffectSpec {
+    ItemType type;              // 道具类型
+    EffectTarget target;        // 作用对象
+    int duration;               // 持续时间（毫秒），立即生效的道具为0
+    ReplayTick endTicks[3];     // 效果结束时录制的重放事件
+    quint32 keyframeFlags[3];   // 关键帧中表示效果生效的ReplayKeyframeFlag
+
+    // 受影响的玩家
+    // collector: 拾取道具的玩家
+    int targetOf(int collector) const;
+};
+
+// 查找道具的效果登记
+// 新道具只需在登记表中加一行，持续时间、作用对象、重放和存档都按表处理
+const EffectSpec* effectSpec(ItemType type);
+
+// 查找重放的结束事件对应的效果
+// tick: 重放中的定时器事件
+// 返回是否找到，找到时写入道具类型和受影响的玩家
+bool effectForTick(ReplayTick tick, ItemType& type, int& playerId);
+
+// 一条效果记录
+struct StatusEffect {
+    ItemType type;      // 道具类型
+    quint8 playerId;    // 受影响的玩家，0表示整个棋盘
+    qint64 expiry;      // 到期的游戏时间（毫秒），-1表示不计时，由重放的结束事件结束
+};
+
+// 道具效果系统
+// 所有持续型效果以记录的形式紧凑存放，由调度器在最早的到期时间统一处理
+// 同类效果可以叠加为多条记录，最后一条到期时效果才结束
+class EffectSystem
+{
+public:
+    // 施加效果
+    // type: 道具类型
+    // playerId: 受影响的玩家，0表示整个棋盘
+    // expiry: 到期的游戏时间，-1表示不计时
+    // 返回效果是否从无到有
+    bool apply(ItemType type, int playerId, qint64 expiry);
+
+    // 结束效果，叠加的记录一并移除
+    // 返回是否有记录被移除
+    bool end(ItemType type, int playerId);
+
+    // 效果是否生效中
+    bool isActive(ItemType type, int playerId = 0) const;
+
+    // 同类效果叠加的记录数
+    int stacks(ItemType type, int playerId = 0) const;
+
+    // 移除到期的记录
+    // now: 当前游戏时间
+    // 返回随之结束的效果（同类已没有剩余记录），按到期时间排序
+    QVector<StatusEffect> expire(qint64 now);
+
+    // 最早的到期时间，没有计时的记录时返回-1
+    qint64 nextExpiry() const;
+
+    // 清空所有记录
+    void clear() { records.clear(); }
+
+    // 所有记录
+    const QVector<StatusEffect>& all() const { return records; }
+
+    // 生效中的效果对应的关键帧标志
+    quint32 keyframeFlags() const;
+
+    // 保存所有记录，到期时间换算为剩余时间
+    // now: 当前游戏时间
+    QVector<StatusEffect> save(qint64 now) const;
+
+    // 恢复保存的记录，替换当前的全部记录
+    // saved: save保存的记录
+    // flags: 关键帧标志，标志生效但没有对应记录的效果按完整时长计时
+    // now: 当前游戏时间
+    // timed: 是否计时，为false时所有记录都由重放的结束事件结束
+    void restore(const QVector<StatusEffect>& saved, quint32 flags, qint64 now, bool timed);
+
+private:
+    QVector<StatusEffect> records; // 效果记录，顺序随施加和到期变化
+};
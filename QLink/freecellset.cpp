@@ -0,0 +1,56 @@
+#include "freecellset.h"
+
+// 清空集合并设置地图尺寸
+void FreeCellSet::reset(int newRows, int newCols)
+{
+    rows = newRows;
+    cols = newCols;
+    cells.clear();
+    positions.fill(-1, rows * cols);
+}
+
+// 格子编号
+int FreeCellSet::indexOf(const QPoint& cell) const
+{
+    if (cell.x() < 0 || cell.x() >= cols || cell.y() < 0 || cell.y() >= rows) return -1;
+    return cell.y() * cols + cell.x();
+}
+
+// 加入一格
+bool FreeCellSet::insert(const QPoint& cell)
+{
+    int index = indexOf(cell);
+    if (index < 0 || positions[index] >= 0) return false;
+    positions[index] = cells.size();
+    cells.append(cell);
+    return true;
+}
+
+// 移除一格
+// 把末尾的格子移到被移除的位置，只需更新它的下标
+bool FreeCellSet::remove(const QPoint& cell)
+{
+    int index = indexOf(cell);
+    if (index < 0 || positions[index] < 0) return false;
+    int pos = positions[index];
+    const QPoint last = cells.last();
+    cells[pos] = last;
+    positions[indexOf(last)] = pos;
+    cells.removeLast();
+    positions[index] = -1;
+    return true;
+}
+
+// 是否包含某格
+bool FreeCellSet::contains(const QPoint& cell) const
+{
+    int index = indexOf(cell);
+    return index >= 0 && positions[index] >= 0;
+}
+
+// 等概率抽取一格
+QPoint FreeCellSet::draw(QRandomGenerator& rng) const
+{
+    if (cells.isEmpty()) return QPoint(-1, -1);
+    return cells[rng.bounded(int(cells.size()))];
+}
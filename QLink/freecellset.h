@@ -0,0 +1,45 @@
+#pragma once
+#include <QPoint>
+#include <QRandomGenerator>
+#include <QVector>
+
+// 空闲格集合
+// 空闲格存放在紧凑数组中，另用按格子编号的下标表记录每格在数组中的位置
+// 加入、移除（与末尾元素交换后删除）和等概率随机抽取都是O(1)，生成道具不必扫描整个棋盘
+class FreeCellSet
+{
+public:
+    // 清空集合并设置地图尺寸
+    // rows, cols: 地图行数和列数
+    void reset(int rows, int cols);
+
+    // 加入一格
+    // cell: 地图坐标
+    // 返回是否加入，超出地图或已在集合中时返回false
+    bool insert(const QPoint& cell);
+
+    // 移除一格
+    // cell: 地图坐标
+    // 返回是否移除，不在集合中时返回false
+    bool remove(const QPoint& cell);
+
+    // 是否包含某格
+    bool contains(const QPoint& cell) const;
+
+    int size() const { return cells.size(); }        // 空闲格数量
+    bool isEmpty() const { return cells.isEmpty(); } // 是否没有空闲格
+    const QPoint& at(int i) const { return cells[i]; } // 按数组顺序获取空闲格
+
+    // 等概率抽取一格
+    // rng: 随机数生成器
+    // 集合为空时返回(-1,-1)
+    QPoint draw(QRandomGenerator& rng) const;
+
+private:
+    // 格子编号，超出地图时返回-1
+    int indexOf(const QPoint& cell) const;
+
+    int rows = 0, cols = 0;      // 地图行数和列数
+    QVector<QPoint> cells;       // 空闲格，顺序随加入和移除变化
+    QVector<int> positions;      // 每格在cells中的下标，不在集合中为-1
+};
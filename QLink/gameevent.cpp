@@ -0,0 +1,67 @@
+#include "gameevent.h"
+
+// 构造一个状态变化
+// type: 变化类型
+// playerId: 相关的玩家
+// a, b: 坐标
+// value: 附加数值
+static GameEvent makeEvent(GameEventType type, int playerId, const QPoint& a, const QPoint& b, int value) {
+    GameEvent event;
+    event.type = type;
+    event.playerId = playerId;
+    event.a = a;
+    event.b = b;
+    event.value = value;
+    return event;
+}
+
+// 消除一对方块
+GameEvent GameEvent::cellsCleared(const QPoint& a, const QPoint& b, int playerId) {
+    return makeEvent(GameEventType::CellsCleared, playerId, a, b, 0);
+}
+
+// 玩家移动
+GameEvent GameEvent::playerMoved(int playerId, const QPoint& pos) {
+    return makeEvent(GameEventType::PlayerMoved, playerId, pos, QPoint(-1, -1), 0);
+}
+
+// 生成道具
+GameEvent GameEvent::propSpawned(const QPoint& pos, ItemType type) {
+    return makeEvent(GameEventType::PropSpawned, 0, pos, QPoint(-1, -1), static_cast<int>(type));
+}
+
+// 拾取道具
+GameEvent GameEvent::propCollected(int playerId, const QPoint& pos, ItemType type) {
+    return makeEvent(GameEventType::PropCollected, playerId, pos, QPoint(-1, -1), static_cast<int>(type));
+}
+
+// 道具效果开始
+GameEvent GameEvent::effectStarted(int playerId, ItemType type) {
+    return makeEvent(GameEventType::EffectStarted, playerId, QPoint(-1, -1), QPoint(-1, -1), static_cast<int>(type));
+}
+
+// 道具效果结束
+GameEvent GameEvent::effectEnded(int playerId, ItemType type) {
+    return makeEvent(GameEventType::EffectEnded, playerId, QPoint(-1, -1), QPoint(-1, -1), static_cast<int>(type));
+}
+
+// 洗牌
+// 种子按位保存在value中
+GameEvent GameEvent::shuffled(quint32 seed) {
+    return makeEvent(GameEventType::Shuffled, 0, QPoint(-1, -1), QPoint(-1, -1), static_cast<int>(seed));
+}
+
+// 分数变化
+GameEvent GameEvent::scoreChanged(int playerId, int score) {
+    return makeEvent(GameEventType::ScoreChanged, playerId, QPoint(-1, -1), QPoint(-1, -1), score);
+}
+
+// 剩余时间变化
+GameEvent GameEvent::timeChanged(int seconds) {
+    return makeEvent(GameEventType::TimeChanged, 0, QPoint(-1, -1), QPoint(-1, -1), seconds);
+}
+
+// 局面被整体替换
+GameEvent GameEvent::boardReset(const QPoint& player1Pos, const QPoint& player2Pos, int timeLeft) {
+    return makeEvent(GameEventType::BoardReset, 0, player1Pos, player2Pos, timeLeft);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QMetaType>
+#include <QPoint>
+#include "item.h"
+
+// 对局状态变化类型
+enum class GameEventType : quint8 {
+    CellsCleared,   // 消除一对方块：a、b为两个方块，playerId为得分的玩家
+    PlayerMoved,    // 玩家移动：a为新位置
+    PropSpawned,    // 生成道具：a为位置，value为道具类型
+    PropCollected,  // 拾取道具：a为位置，value为道具类型，playerId为拾取的玩家
+    EffectStarted,  // 道具效果开始：value为道具类型，playerId为受影响的玩家，0表示整个棋盘
+    EffectEnded,    // 道具效果结束：value为道具类型，playerId为受影响的玩家，0表示整个棋盘
+    Shuffled,       // 洗牌：value为随机种子
+    ScoreChanged,   // 分数变化：value为新分数
+    TimeChanged,    // 剩余时间变化：value为剩余秒数
+    BoardReset      // 局面被整体替换（读档、撤销）：a、b为两个玩家的位置，value为剩余时间
+};
+
+// 对局状态变化
+// 游戏逻辑在状态变化时发出，订阅者（自动存档日志、分数显示、Hint、游戏结束判定等）只处理变化的部分
+struct GameEvent {
+    GameEventType type = GameEventType::BoardReset; // 变化类型
+    int playerId = 0;                    // 相关的玩家（1或2），与玩家无关时为0
+    QPoint a{-1, -1};                    // 第一个坐标
+    QPoint b{-1, -1};                    // 第二个坐标
+    int value = 0;                       // 附加数值，含义见GameEventType
+
+    // 道具类型，用于PropSpawned、PropCollected、EffectStarted和EffectEnded
+    ItemType item() const { return static_cast<ItemType>(value); }
+
+    static GameEvent cellsCleared(const QPoint& a, const QPoint& b, int playerId); // 消除一对方块
+    static GameEvent playerMoved(int playerId, const QPoint& pos);                 // 玩家移动
+    static GameEvent propSpawned(const QPoint& pos, ItemType type);                // 生成道具
+    static GameEvent propCollected(int playerId, const QPoint& pos, ItemType type); // 拾取道具
+    static GameEvent effectStarted(int playerId, ItemType type);                   // 道具效果开始
+    static GameEvent effectEnded(int playerId, ItemType type);                     // 道具效果结束
+    static GameEvent shuffled(quint32 seed);                                       // 洗牌
+    static GameEvent scoreChanged(int playerId, int score);                        // 分数变化
+    static GameEvent timeChanged(int seconds);                                     // 剩余时间变化
+    static GameEvent boardReset(const QPoint& player1Pos, const QPoint& player2Pos, int timeLeft); // 局面被整体替换
+};
+
+Q_DECLARE_METATYPE(GameEvent)
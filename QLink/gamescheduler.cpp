@@ -0,0 +1,151 @@
+#include "gamescheduler.h"
+#include <algorithm>
+
+// 构造函数
+// parent: 父对象指针
+// manual: 是否使用手动时钟
+GameScheduler::GameScheduler(QObject* parent, bool manual)
+    : QObject(parent)
+    , timer(new QTimer(this))
+    , manual(manual)
+{
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &GameScheduler::wake);
+    clock.start();
+}
+
+// 堆比较：截止时间晚的排在后面，同时到期时按事件编号排序，保证触发顺序确定
+bool GameScheduler::later(const Deadline& a, const Deadline& b)
+{
+    return a.time != b.time ? a.time > b.time : a.id > b.id;
+}
+
+// 当前游戏时间
+qint64 GameScheduler::now() const
+{
+    return (paused ? pausedAt : clockTime()) - pausedTotal;
+}
+
+// 推进手动时钟
+// ms: 推进的毫秒数
+// 每次把时钟拨到最早的截止时间再触发，处理函数新安排的事件从触发时刻起算
+void GameScheduler::advance(qint64 ms)
+{
+    if (!manual || paused) return;
+    const qint64 target = now() + ms;
+    rearm();
+    while (!paused && !heap.isEmpty() && heap.front().time <= target) {
+        manualTime = std::max(manualTime, heap.front().time + pausedTotal);
+        wake();
+    }
+    if (!paused) manualTime = std::max(manualTime, target + pausedTotal);
+}
+
+// 安排定时事件
+// id: 定时事件
+// delay: 距触发的毫秒数
+// period: 重复周期
+void GameScheduler::schedule(GameTimer id, qint64 delay, qint64 period)
+{
+    Entry entry{now() + std::max<qint64>(0, delay), period, nextGeneration++};
+    entries.insert(int(id), entry);
+    heap.append(Deadline{entry.deadline, int(id), entry.generation});
+    std::push_heap(heap.begin(), heap.end(), &GameScheduler::later);
+    rearm();
+}
+
+// 取消定时事件
+void GameScheduler::cancel(GameTimer id)
+{
+    if (entries.remove(int(id))) rearm();
+}
+
+// 取消所有定时事件
+void GameScheduler::clear()
+{
+    entries.clear();
+    heap.clear();
+    timer->stop();
+}
+
+// 获取距触发的剩余时间
+qint64 GameScheduler::remaining(GameTimer id) const
+{
+    auto it = entries.constFind(int(id));
+    if (it == entries.constEnd()) return -1;
+    return std::max<qint64>(0, it->deadline - now());
+}
+
+// 暂停
+void GameScheduler::pause()
+{
+    if (paused) return;
+    pausedAt = clockTime();
+    paused = true;
+    timer->stop();
+}
+
+// 恢复
+void GameScheduler::resume()
+{
+    if (!paused) return;
+    pausedTotal += clockTime() - pausedAt;
+    paused = false;
+    rearm();
+}
+
+// 保存所有定时事件
+QVector<ScheduledTimer> GameScheduler::save() const
+{
+    QVector<ScheduledTimer> timers;
+    const qint64 t = now();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+        timers.append(ScheduledTimer{GameTimer(it.key()), std::max<qint64>(0, it->deadline - t), it->period});
+    return timers;
+}
+
+// 恢复保存的定时事件
+void GameScheduler::restore(const QVector<ScheduledTimer>& timers)
+{
+    clear();
+    for (const ScheduledTimer& saved : timers) schedule(saved.id, saved.remaining, saved.period);
+}
+
+// 唤醒
+// 周期事件按周期推进截止时间，错过多次时逐次补发，倒计时不会丢秒
+void GameScheduler::wake()
+{
+    while (!paused && !heap.isEmpty() && heap.front().time <= now()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        Deadline due = heap.takeLast();
+        auto it = entries.find(due.id);
+        if (it == entries.end() || it->generation != due.generation) continue; // 已被替换或取消
+        if (it->period > 0) {
+            it->deadline += it->period;
+            heap.append(Deadline{it->deadline, due.id, it->generation});
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            entries.erase(it);
+        }
+        emit fired(GameTimer(due.id)); // 处理函数可能重新安排、取消或暂停
+    }
+    rearm();
+}
+
+// 按最早的截止时间重新设置唤醒定时器
+void GameScheduler::rearm()
+{
+    // 丢弃堆顶已失效的截止时间
+    while (!heap.isEmpty()) {
+        auto it = entries.constFind(heap.front().id);
+        if (it != entries.constEnd() && it->generation == heap.front().generation) break;
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.removeLast();
+    }
+    if (paused || heap.isEmpty() || manual) {
+        timer->stop();
+        return;
+    }
+    timer->start(int(std::max<qint64>(0, heap.front().time - now())));
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+
+// 游戏定时事件
+enum class GameTimer : int {
+    Progress,   // 每秒倒计时
+    Prop,       // 生成道具
+    Autosave,   // 自动存档快照
+    Step,       // 执行一步模拟，处理排队的输入
+    Effect      // 最早的道具效果到期
+};
+
+// 一个定时事件的状态，用于保存和恢复
+struct ScheduledTimer {
+    GameTimer id;       // 定时事件
+    qint64 remaining;   // 距下次触发的游戏时间（毫秒）
+    qint64 period;      // 重复周期（毫秒），0表示只触发一次
+};
+
+// 游戏调度器
+// 所有定时事件的截止时间放在一个最小堆中，只用一个单次QTimer在最早的截止时间唤醒
+// 截止时间按游戏时间计算：暂停时游戏时钟停走，恢复后每个事件都保留暂停前的剩余时间
+// 手动时钟模式下游戏时间只由advance推进，无窗口模拟可以不等待地快进
+class GameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 构造函数
+    // parent: 父对象指针
+    // manual: 是否使用手动时钟，为true时不启动唤醒定时器
+    explicit GameScheduler(QObject* parent = nullptr, bool manual = false);
+
+    // 当前游戏时间（毫秒）
+    qint64 now() const;
+
+    // 推进手动时钟
+    // ms: 推进的毫秒数
+    // 按截止时间顺序同步触发期间到期的所有事件；暂停中或不是手动时钟时不做任何事
+    void advance(qint64 ms);
+
+    // 安排定时事件
+    // id: 定时事件，已安排的同一事件会被替换
+    // delay: 距触发的毫秒数
+    // period: 重复周期（毫秒），0表示只触发一次
+    void schedule(GameTimer id, qint64 delay, qint64 period = 0);
+
+    // 取消定时事件
+    void cancel(GameTimer id);
+
+    // 取消所有定时事件
+    void clear();
+
+    // 定时事件是否已安排
+    bool isScheduled(GameTimer id) const { return entries.contains(int(id)); }
+
+    // 获取距触发的剩余时间（毫秒），未安排时返回-1
+    qint64 remaining(GameTimer id) const;
+
+    // 暂停：游戏时钟停走，不再唤醒
+    void pause();
+
+    // 恢复：游戏时钟继续走，所有事件保留暂停前的剩余时间
+    void resume();
+
+    // 是否暂停中
+    bool isPaused() const { return paused; }
+
+    // 保存所有定时事件的剩余时间和周期
+    QVector<ScheduledTimer> save() const;
+
+    // 恢复保存的定时事件，替换当前的全部事件
+    void restore(const QVector<ScheduledTimer>& timers);
+
+signals:
+    // 定时事件触发
+    // id: 触发的事件
+    void fired(GameTimer id);
+
+private slots:
+    // 唤醒：按截止时间顺序触发所有到期的事件
+    void wake();
+
+private:
+    // 时钟读数：手动时钟或单调时钟（毫秒）
+    qint64 clockTime() const { return manual ? manualTime : clock.elapsed(); }
+
+    // 按最早的截止时间重新设置唤醒定时器
+    void rearm();
+
+    // 堆中的截止时间
+    struct Deadline {
+        qint64 time;        // 截止的游戏时间
+        int id;             // 定时事件
+        quint32 generation; // 安排时的代数，与entries不一致时说明已被替换或取消
+    };
+
+    // 堆比较：a的截止时间是否晚于b
+    static bool later(const Deadline& a, const Deadline& b);
+
+    // 定时事件的当前安排
+    struct Entry {
+        qint64 deadline;    // 截止的游戏时间
+        qint64 period;      // 重复周期，0表示只触发一次
+        quint32 generation; // 代数
+    };
+
+    QTimer* timer;                 // 唯一的唤醒定时器
+    QElapsedTimer clock;           // 单调时钟
+    bool manual;                   // 是否使用手动时钟
+    qint64 manualTime = 0;         // 手动时钟的读数
+    qint64 pausedTotal = 0;        // 累计暂停的时间
+    qint64 pausedAt = 0;           // 本次暂停开始的单调时间
+    bool paused = false;           // 是否暂停中
+    quint32 nextGeneration = 0;    // 下一个代数
+    QVector<Deadline> heap;        // 截止时间最小堆，被替换或取消的事件延迟到出堆时丢弃
+    QHash<int, Entry> entries;     // 各定时事件的当前安排
+};
@@ -0,0 +1,82 @@
+#include "hintsolver.h"
+#include "packedboard.h"
+#include <QtGlobal>
+
+// 查找一对可以消除的方块
+// 只在外圈两层以内查找方块，外圈只用作连线通道
+bool findLinkPair(const QByteArray& cells, int rows, int cols, QPoint& a, QPoint& b,
+                  const std::function<bool()>& cancelled)
+{
+    a = b = QPoint(-1, -1);
+    if (cells.size() != rows * cols) return false;
+    const PackedBoard board(cells, rows, cols);
+    for (int i = 2; i < rows - 2; ++i) {
+        if (cancelled && cancelled()) return false;
+        for (int j = 2; j < cols - 2; ++j) {
+            if (board.isEmpty(j, i)) continue;
+            for (int ii = 2; ii < rows - 2; ++ii) {
+                for (int jj = 2; jj < cols - 2; ++jj) {
+                    if (i == ii && j == jj) continue;
+                    if (board.isEmpty(jj, ii) || board.form(j, i) != board.form(jj, ii)) continue;
+                    if (board.canLink(j, i, jj, ii)) {
+                        a = QPoint(j, i);
+                        b = QPoint(jj, ii);
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// 读取死局处理策略
+DeadBoardPolicy deadBoardPolicyFromEnvironment()
+{
+    return qEnvironmentVariableIsSet("QLINK_DEAD_BOARD_END") ? DeadBoardPolicy::End : DeadBoardPolicy::Reshuffle;
+}
+
+// 构造函数
+// parent: 父对象
+HintSolver::HintSolver(QObject* parent)
+    : QObject(parent)
+{
+    worker.setMaxThreadCount(1);
+}
+
+// 析构函数
+HintSolver::~HintSolver()
+{
+    generation.fetchAndAddOrdered(1);
+    worker.waitForDone();
+}
+
+// 提交棋盘
+// 后台线程只读自己持有的那份压缩棋盘，GUI线程之后的修改不影响它
+void HintSolver::submit(const QByteArray& cells, int rows, int cols)
+{
+    const int started = generation.fetchAndAddOrdered(1) + 1;
+    ready = false;
+    pending = true;
+    worker.start([this, cells, rows, cols, started]() {
+        QPoint a, b;
+        findLinkPair(cells, rows, cols, a, b, [this, started]() { return generation.loadAcquire() != started; });
+        if (generation.loadAcquire() != started) return;
+        QMetaObject::invokeMethod(this, [this, a, b, started]() {
+            if (generation.loadAcquire() != started) return; // 送回途中又有新的提交
+            ready = true;
+            pending = false;
+            pair1 = a;
+            pair2 = b;
+            emit solved(a, b);
+        }, Qt::QueuedConnection);
+    });
+}
+
+// 作废进行中的查找和已有的结果
+void HintSolver::cancel()
+{
+    generation.fetchAndAddOrdered(1);
+    ready = false;
+    pending = false;
+}
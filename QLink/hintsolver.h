@@ -0,0 +1,77 @@
+#pragma once
+#include <QObject>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QPoint>
+#include <QThreadPool>
+#include <functional>
+
+// 查找一对可以消除的方块
+// cells: 压缩棋盘（见packBlock），按行存储
+// rows, cols: 地图行数和列数
+// a, b: 用于存储找到的两个方块的地图坐标
+// cancelled: 返回true时放弃查找，可以为空
+// 返回是否找到；按行优先顺序返回第一对，与游戏窗口中的判定规则一致
+bool findLinkPair(const QByteArray& cells, int rows, int cols, QPoint& a, QPoint& b,
+                  const std::function<bool()>& cancelled = nullptr);
+
+// 死局（没有可消除对）的处理策略
+enum class DeadBoardPolicy {
+    Reshuffle, // 自动洗牌，连续洗牌deadBoardShuffleLimit次仍是死局时结束对局
+    End        // 直接结束对局
+};
+
+// 连续自动洗牌的次数上限，期间有消除时重新计数
+const int deadBoardShuffleLimit = 5;
+
+// 读取死局处理策略
+// 设置了环境变量QLINK_DEAD_BOARD_END时直接结束对局，否则自动洗牌
+DeadBoardPolicy deadBoardPolicyFromEnvironment();
+
+// 后台Hint查找器
+// 棋盘每次变化时提交一份不可变的压缩棋盘，由后台线程查找可消除的方块对，结果送回GUI线程
+// 新的提交使进行中的查找作废：查找循环发现代数变化后立即放弃，过期的结果也不会送回
+class HintSolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 构造函数
+    // parent: 父对象
+    explicit HintSolver(QObject* parent = nullptr);
+
+    // 析构函数
+    // 作废进行中的查找并等待后台线程结束
+    ~HintSolver();
+
+    // 提交棋盘
+    // cells: 压缩棋盘，隐式共享，只增加引用计数
+    // rows, cols: 地图行数和列数
+    // 立即返回，之前的结果作废
+    void submit(const QByteArray& cells, int rows, int cols);
+
+    // 作废进行中的查找和已有的结果
+    void cancel();
+
+    // 最近一次提交的结果是否已送回
+    bool isReady() const { return ready; }
+
+    // 是否有还没送回结果的提交
+    bool isPending() const { return pending; }
+
+    QPoint first() const { return pair1; }   // 结果中的第一个方块，没有可消除对时为(-1,-1)
+    QPoint second() const { return pair2; }  // 结果中的第二个方块，没有可消除对时为(-1,-1)
+
+signals:
+    // 查找完成
+    // a, b: 可消除的方块对，没有时都为(-1,-1)
+    void solved(const QPoint& a, const QPoint& b);
+
+private:
+    QThreadPool worker;            // 单线程后台工作池
+    QAtomicInt generation;         // 提交的代数，后台线程据此判断查找是否已作废
+    bool ready = false;            // 结果是否对应最近一次提交
+    bool pending = false;          // 最近一次提交是否还在查找中
+    QPoint pair1{-1, -1};          // 结果中的第一个方块
+    QPoint pair2{-1, -1};          // 结果中的第二个方块
+};
@@ -1,6 +1,20 @@
 #include "item.h"
 #include <QPainter>
 
+// 获取道具贴图路径
+// type: 道具类型
+QString itemTextureFile(ItemType type) {
+    switch (type) {
+        case ItemType::AddTime: return ":/images/images/Time.png";
+        case ItemType::Shuffle: return ":/images/images/Shuffle.png";
+        case ItemType::Hint:    return ":/images/images/Hint.png";
+        case ItemType::Flash:   return ":/images/images/Flash.png";
+        case ItemType::Freeze:  return ":/images/images/Freeze.png";
+        case ItemType::Dizzy:   return ":/images/images/Dizzy.png";
+    }
+    return QString();
+}
+
 // 默认构造函数
 Item::Item()
     : type(ItemType::AddTime), mapPos(0, 0), rect(0, 0, 0, 0), pixmap(), visible(false)
@@ -52,15 +66,9 @@ void Item::setPixmap(const QPixmap& p) { pixmap = p; }
 // 绘制道具
 void Item::draw(QPainter& painter) const {
     if (visible && !pixmap.isNull()) {
-        int w = 46, h = 46; // 道具图标的固定尺寸
-        int cx = rect.x() + rect.width() / 2;  // 计算道具矩形的中心x坐标
-        int cy = rect.y() + rect.height() / 2; // 计算道具矩形的中心y坐标
-        QRect targetRect(cx - w/2, cy - h/2, w, h); // 创建目标绘制矩形（居中）
-        painter.drawPixmap(targetRect, pixmap.scaled(w, h, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+        QSizeF size = pixmap.deviceIndependentSize(); // 图标的逻辑尺寸
+        qreal x = rect.x() + (rect.width() - size.width()) / 2;   // 居中后的x坐标
+        qreal y = rect.y() + (rect.height() - size.height()) / 2; // 居中后的y坐标
+        painter.drawPixmap(QPointF(x, y), pixmap); // 图标已预先缩放，一比一绘制
     }
 }
-
-// 触发道具效果
-void Item::triggerEffect(QWidget* /*gameWidget*/) {
-    // 具体效果由主逻辑或子类实现
-}
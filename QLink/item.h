@@ -14,9 +14,14 @@ enum class ItemType {
     Dizzy       // 眩晕道具：使对手方向控制颠倒
 };
 
+// 获取道具贴图路径
+// type: 道具类型
+// 返回道具类型对应的贴图资源路径
+QString itemTextureFile(ItemType type);
+
 // 游戏道具类
 // 表示游戏中的一个道具，包含道具类型、位置、图标等属性
-// 提供道具的绘制和效果触发功能
+// 提供道具的绘制功能，拾取后的效果由效果系统处理
 class Item {
 public:
     // 默认构造函数
@@ -87,15 +92,11 @@ public:
 
     // 绘制道具
     // painter: 绘图设备
-    // 在指定的绘图设备上绘制道具图标
+    // 在指定的绘图设备上绘制道具图标，图标居中于道具矩形
+    // 图标应已按格子尺寸预先缩放，绘制时不再缩放
     // 只有当道具可见且图标有效时才进行绘制
     virtual void draw(QPainter& painter) const;
 
-    // 触发道具效果
-    // gameWidget: 游戏窗口指针
-    // 触发道具的具体效果，具体实现由子类或主逻辑完成
-    virtual void triggerEffect(QWidget* gameWidget);
-
 protected:
     ItemType type;      // 道具类型
     QPoint mapPos;      // 道具在地图中的逻辑坐标
@@ -0,0 +1,71 @@
+#include "keyrepeat.h"
+#include <QtGlobal>
+#include <algorithm>
+
+// 构造函数
+// delay: 重复延迟
+// interval: 重复间隔
+KeyRepeat::KeyRepeat(int delay, int interval)
+    : repeatDelay(std::max(0, delay))
+    , repeatInterval(std::max(1, interval))
+{
+}
+
+// 按环境变量创建
+KeyRepeat KeyRepeat::fromEnvironment()
+{
+    bool ok = false;
+    int delay = qEnvironmentVariableIntValue("QLINK_REPEAT_DELAY", &ok);
+    if (!ok || delay < 0) delay = keyRepeatDelay;
+    int interval = qEnvironmentVariableIntValue("QLINK_REPEAT_INTERVAL", &ok);
+    if (!ok || interval <= 0) interval = keyRepeatInterval;
+    return KeyRepeat(delay, interval);
+}
+
+// 按下方向键
+// 按下的瞬间由调用方作为一次普通输入执行，这里只开始计算重复延迟
+void KeyRepeat::press(int key, int playerId, qint64 now)
+{
+    if (playerId < 1 || playerId > 2) return;
+    PlayerKeys& keys = players[playerId - 1];
+    keys.held.removeAll(key);
+    keys.held.append(key);
+    keys.nextRepeat = now + repeatDelay;
+}
+
+// 松开方向键
+void KeyRepeat::release(int key, qint64 now)
+{
+    for (PlayerKeys& keys : players) {
+        int index = keys.held.indexOf(key);
+        if (index < 0) continue;
+        keys.held.remove(index);
+        if (index == keys.held.size() && !keys.held.isEmpty()) keys.nextRepeat = now + repeatDelay;
+    }
+}
+
+// 松开所有按键
+void KeyRepeat::releaseAll()
+{
+    for (PlayerKeys& keys : players) keys.held.clear();
+}
+
+// 是否有按住的方向键
+bool KeyRepeat::isHeld() const
+{
+    return !players[0].held.isEmpty() || !players[1].held.isEmpty();
+}
+
+// 采样一步
+// 重复按固定间隔推进，步长不整除间隔时也不会累积偏差；落后超过一个间隔时不补发
+QVector<int> KeyRepeat::sample(qint64 now)
+{
+    QVector<int> keys;
+    for (PlayerKeys& player : players) {
+        if (player.held.isEmpty() || now < player.nextRepeat) continue;
+        keys.append(player.held.last());
+        player.nextRepeat += repeatInterval;
+        if (player.nextRepeat <= now) player.nextRepeat = now + repeatInterval;
+    }
+    return keys;
+}
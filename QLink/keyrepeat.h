@@ -0,0 +1,60 @@
+#pragma once
+#include <QVector>
+#include <array>
+
+const int keyRepeatDelay = 200;    // 默认的重复延迟（毫秒）
+const int keyRepeatInterval = 60;  // 默认的重复间隔（毫秒）
+
+// 按键状态与按玩家的移动重复
+// 只跟踪按下和松开，不依赖系统的自动重复：每个玩家独立计时，按住方向键满重复延迟后每隔重复间隔移动一次
+// 两个玩家在每一步模拟都被采样，一方按住不放不会挤占另一方；同一玩家按住多个方向键时以最后按下的为准
+class KeyRepeat
+{
+public:
+    // 构造函数
+    // delay: 按下后开始重复的延迟（毫秒）
+    // interval: 重复的间隔（毫秒）
+    explicit KeyRepeat(int delay = keyRepeatDelay, int interval = keyRepeatInterval);
+
+    // 按环境变量创建
+    // QLINK_REPEAT_DELAY和QLINK_REPEAT_INTERVAL分别设置延迟和间隔（毫秒），未设置或无效时使用默认值
+    static KeyRepeat fromEnvironment();
+
+    // 按下方向键
+    // key: Qt::Key
+    // playerId: 玩家ID（1或2）
+    // now: 当前游戏时间（毫秒）
+    void press(int key, int playerId, qint64 now);
+
+    // 松开方向键
+    // key: Qt::Key
+    // now: 当前游戏时间（毫秒）
+    // 松开最后按下的键而仍按着其他键时，从现在起重新计算重复延迟
+    void release(int key, qint64 now);
+
+    // 松开所有按键
+    // 暂停或窗口失去焦点后收不到松开事件，必须清空按键状态
+    void releaseAll();
+
+    // 是否有按住的方向键
+    bool isHeld() const;
+
+    // 采样一步
+    // now: 当前游戏时间（毫秒）
+    // 返回本步到期需要重复的按键，每个玩家最多一个，按玩家顺序排列
+    QVector<int> sample(qint64 now);
+
+    int delay() const { return repeatDelay; }        // 重复延迟（毫秒）
+    int interval() const { return repeatInterval; }  // 重复间隔（毫秒）
+
+private:
+    // 一个玩家的按键状态
+    struct PlayerKeys {
+        QVector<int> held;      // 按住的方向键，按按下顺序
+        qint64 nextRepeat = 0;  // 下次重复的游戏时间
+    };
+
+    int repeatDelay;                   // 重复延迟
+    int repeatInterval;                // 重复间隔
+    std::array<PlayerKeys, 2> players; // 两个玩家的按键状态
+};
@@ -0,0 +1,68 @@
+#include "latencyprobe.h"
+#include <algorithm>
+
+// 构造函数
+LatencyProbe::LatencyProbe()
+{
+    clock.start();
+}
+
+// 记录一次排队后才执行的输入
+// stamp: 收到输入的时间
+void LatencyProbe::inputReceived(qint64 stamp)
+{
+    pending.append(Pending{stamp, -1});
+}
+
+// 标记当前输入触发的动作
+// action: 动作类型
+void LatencyProbe::classify(InputAction action)
+{
+    if (pending.isEmpty()) return; // 非输入触发的动作（如定时器）不统计
+    pending.last().action = std::max(pending.last().action, static_cast<int>(action));
+}
+
+// 一帧绘制完成
+void LatencyProbe::frameFinished()
+{
+    if (pending.isEmpty()) return;
+    qint64 now = clock.nsecsElapsed();
+    for (const Pending& p : pending)
+        if (p.action >= 0) samples[p.action].append(now - p.stamp);
+    pending.clear();
+}
+
+// 获取延迟百分位数
+// action: 动作类型
+// percent: 百分位（0-100）
+qint64 LatencyProbe::percentile(InputAction action, int percent) const
+{
+    QVector<qint64> sorted = samples[static_cast<int>(action)];
+    if (sorted.isEmpty()) return -1;
+    int index = std::min(int(sorted.size()) - 1, int(sorted.size()) * percent / 100);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index] / 1000;
+}
+
+// 获取样本数量
+int LatencyProbe::sampleCount(InputAction action) const
+{
+    return samples[static_cast<int>(action)].size();
+}
+
+// 生成统计报告
+QString LatencyProbe::report() const
+{
+    static const char* names[3] = {"move", "activate", "eliminate"};
+    QString text = "input-to-paint latency (us):";
+    for (int i = 0; i < 3; ++i) {
+        InputAction action = static_cast<InputAction>(i);
+        text += QString("\n  %1: n=%2 p50=%3 p95=%4 p99=%5")
+                    .arg(names[i])
+                    .arg(sampleCount(action))
+                    .arg(percentile(action, 50))
+                    .arg(percentile(action, 95))
+                    .arg(percentile(action, 99));
+    }
+    return text;
+}
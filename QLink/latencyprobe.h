@@ -0,0 +1,66 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+// 输入动作类型
+// 同一次输入可能依次触发多个动作，统计时按最重的动作归类
+enum class InputAction {
+    Move,       // 玩家移动
+    Activate,   // 激活或切换方块
+    Eliminate   // 消除一对方块
+};
+
+// 输入延迟探针
+// 在按键和鼠标事件开始处记录单调时间，在随后的绘制结束时计算延迟
+// 按动作类型分别统计 p50/p95/p99，用于验证游戏的响应速度
+class LatencyProbe
+{
+public:
+    // 构造函数
+    // 启动单调时钟
+    LatencyProbe();
+
+    // 记录一次排队后才执行的输入
+    // stamp: 收到输入时stamp()的返回值
+    // 在模拟步执行这个输入之前调用，延迟从收到输入时算起
+    void inputReceived(qint64 stamp);
+
+    // 获取当前时间（纳秒）
+    qint64 stamp() const { return clock.nsecsElapsed(); }
+
+    // 标记当前输入触发的动作
+    // action: 动作类型
+    // 只保留最重的动作：消除 > 激活 > 移动
+    void classify(InputAction action);
+
+    // 一帧绘制完成
+    // 在paintEvent末尾调用，为所有已归类的待处理输入记录延迟样本
+    // 没有触发任何动作的输入（如撞墙）不计入统计
+    void frameFinished();
+
+    // 获取延迟百分位数
+    // action: 动作类型
+    // percent: 百分位（0-100）
+    // 返回延迟（微秒），没有样本时返回-1
+    qint64 percentile(InputAction action, int percent) const;
+
+    // 获取样本数量
+    // action: 动作类型
+    int sampleCount(InputAction action) const;
+
+    // 生成统计报告
+    // 返回每种动作的样本数和 p50/p95/p99 延迟
+    QString report() const;
+
+private:
+    // 等待绘制的输入
+    struct Pending {
+        qint64 stamp;   // 输入时间（纳秒）
+        int action;     // 动作类型，-1表示尚未触发动作
+    };
+
+    QElapsedTimer clock;          // 单调时钟
+    QVector<Pending> pending;     // 等待绘制的输入
+    QVector<qint64> samples[3];   // 每种动作的延迟样本（纳秒）
+};
@@ -1,50 +1,182 @@
 #include "load.h"
+#include "block.h"
+#include "boardcodec.h"
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
+#include <QtEndian>
+#include <cstring>
+#include <climits>
+
+static const char saveMagic[4] = {'Q', 'L', 'N', 'K'}; // 二进制存档魔数
+static const quint16 saveVersion = 2;                 // 二进制存档版本号，版本1的方块表未压缩，仍可读取
+static const int saveHeaderSize = 36;                 // 文件头字节数
+static const int savePropSize = 5;                    // 每个道具的字节数
+static const int saveMaxSide = 4096;                  // 地图边长上限，防止损坏的文件申请过大内存
+
+// CRC-32查找表（IEEE 802.3多项式）
+struct Crc32Table {
+    quint32 entries[256];
+    Crc32Table() {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+// 计算CRC-32
+// data: 数据起始地址
+// size: 数据字节数
+static quint32 crc32(const char* data, int size) {
+    static const Crc32Table table;
+    quint32 crc = 0xFFFFFFFFu;
+    for (int i = 0; i < size; ++i)
+        crc = table.entries[(crc ^ uchar(data[i])) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 按小端写入一个整数并前移写指针
+template<typename T>
+static void put(char*& p, T value) {
+    qToLittleEndian<T>(value, p);
+    p += sizeof(T);
+}
+
+// 按小端读取一个整数并前移读指针
+template<typename T>
+static T take(const char*& p) {
+    T value = qFromLittleEndian<T>(p);
+    p += sizeof(T);
+    return value;
+}
+
+// 编码二进制存档
+// data: 要保存的游戏数据
+QByteArray encodeSave(const SaveData& data) {
+    QByteArray board = encodeBoard(data.cells);
+    int propCount = data.propPositions.size();
+    QByteArray bytes(saveHeaderSize + 4 + board.size() + 4 + propCount * savePropSize + 4, Qt::Uninitialized);
+    char* p = bytes.data();
+    // 文件头
+    memcpy(p, saveMagic, 4);
+    p += 4;
+    put<quint16>(p, saveVersion);
+    put<quint8>(p, data.mode == GameMode::Single ? 0 : 1);
+    put<quint8>(p, 0);
+    put<qint32>(p, data.timeLeft);
+    put<qint32>(p, data.score1);
+    put<qint32>(p, data.score2);
+    put<qint16>(p, data.player1Pos.x());
+    put<qint16>(p, data.player1Pos.y());
+    put<qint16>(p, data.player2Pos.x());
+    put<qint16>(p, data.player2Pos.y());
+    put<quint16>(p, data.rows);
+    put<quint16>(p, data.cols);
+    for (int id : data.blockTextureIds) put<quint8>(p, id);
+    put<quint8>(p, 0);
+    // 方块表
+    put<quint32>(p, board.size());
+    memcpy(p, board.constData(), board.size());
+    p += board.size();
+    // 道具表
+    put<quint32>(p, propCount);
+    for (int i = 0; i < propCount; ++i) {
+        put<qint16>(p, data.propPositions[i].x());
+        put<qint16>(p, data.propPositions[i].y());
+        put<quint8>(p, data.propTypes[i]);
+    }
+    // 校验和
+    put<quint32>(p, crc32(bytes.constData(), bytes.size() - 4));
+    return bytes;
+}
+
+// 解码二进制存档
+// bytes: 存档字节
+// data: 用于存储解码的游戏数据
+bool decodeSave(const QByteArray& bytes, SaveData& data) {
+    const int size = bytes.size();
+    if (size < saveHeaderSize + 8 || memcmp(bytes.constData(), saveMagic, 4) != 0) return false;
+    const char* p = bytes.constData() + 4;
+    const quint16 version = take<quint16>(p);
+    if (version < 1 || version > saveVersion) return false;
+    quint8 mode = take<quint8>(p);
+    p += 1;
+    if (mode > 1) return false;
+    SaveData result;
+    result.mode = mode == 0 ? GameMode::Single : GameMode::Duo;
+    result.timeLeft = take<qint32>(p);
+    result.score1 = take<qint32>(p);
+    result.score2 = take<qint32>(p);
+    int x = take<qint16>(p);
+    result.player1Pos = QPoint(x, take<qint16>(p));
+    x = take<qint16>(p);
+    result.player2Pos = QPoint(x, take<qint16>(p));
+    result.rows = take<quint16>(p);
+    result.cols = take<quint16>(p);
+    for (int& id : result.blockTextureIds) id = take<quint8>(p);
+    p += 1;
+    if (result.rows <= 0 || result.cols <= 0 || result.rows > saveMaxSide || result.cols > saveMaxSide) return false;
+    // 先核对长度，再核对CRC，之后的读取都不会越界
+    const int cells = result.rows * result.cols;
+    int boardSize = cells; // 方块表占用的字节数，版本2含4字节长度前缀
+    if (version >= 2) {
+        if (size < saveHeaderSize + 12) return false;
+        const quint32 encodedSize = take<quint32>(p);
+        if (encodedSize > quint32(size)) return false;
+        boardSize = 4 + int(encodedSize);
+    }
+    if (size < saveHeaderSize + boardSize + 8) return false;
+    const char* propTable = bytes.constData() + saveHeaderSize + boardSize;
+    const quint32 propCount = qFromLittleEndian<quint32>(propTable);
+    if (propCount > quint32(cells) || size != saveHeaderSize + boardSize + 4 + int(propCount) * savePropSize + 4) return false;
+    if (crc32(bytes.constData(), size - 4) != qFromLittleEndian<quint32>(bytes.constData() + size - 4)) return false;
+    // 方块表
+    if (version >= 2) {
+        if (!decodeBoard(p, boardSize - 4, cells, result.cells)) return false;
+    } else {
+        for (int i = 0; i < cells; ++i) {
+            uchar cell = uchar(p[i]);
+            if (packedForm(cell) > 2 || packedState(cell) > 2) return false;
+        }
+        result.cells = QByteArray(p, cells);
+    }
+    // 道具表
+    p = propTable + 4;
+    result.propPositions.reserve(propCount);
+    result.propTypes.reserve(propCount);
+    for (quint32 i = 0; i < propCount; ++i) {
+        x = take<qint16>(p);
+        QPoint pos(x, take<qint16>(p));
+        int type = take<quint8>(p);
+        if (pos.x() < 0 || pos.x() >= result.cols || pos.y() < 0 || pos.y() >= result.rows) return false;
+        if (type > static_cast<int>(ItemType::Dizzy)) return false;
+        result.propPositions.append(pos);
+        result.propTypes.append(type);
+    }
+    data = result;
+    return true;
+}
 
 // 保存游戏到文件
 // path: 存档文件路径
 // data: 要保存的游戏数据
 bool saveGame(const QString& path, const SaveData& data) {
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
-    QTextStream out(&file);
-    // 保存游戏模式
-    out << (data.mode == GameMode::Single ? "Single" : "Duo") << "\n";
-    // 保存剩余时间
-    out << data.timeLeft << "\n";
-    // 保存玩家分数
-    out << data.score1 << " " << data.score2 << "\n";
-    // 保存玩家位置
-    out << data.player1Pos.x() << " " << data.player1Pos.y() << "\n";
-    out << data.player2Pos.x() << " " << data.player2Pos.y() << "\n";
-    // 保存地图大小
-    out << data.rows << " " << data.cols << "\n";
-    // 保存方块贴图ID
-    out << data.blockTextureIds[0] << " " << data.blockTextureIds[1] << " " << data.blockTextureIds[2] << "\n";
-    // 保存方块形状矩阵
-    for (int i = 0; i < data.rows; ++i) {
-        for (int j = 0; j < data.cols; ++j)
-            out << data.blockForms[i][j] << " ";
-        out << "\n";
-    }
-    // 保存方块状态矩阵
-    for (int i = 0; i < data.rows; ++i) {
-        for (int j = 0; j < data.cols; ++j)
-            out << data.blockStates[i][j] << " ";
-        out << "\n";
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    QByteArray bytes = encodeSave(data);
+    if (file.write(bytes) != bytes.size()) {
+        file.cancelWriting();
+        return false;
     }
-    // 保存道具信息
-    out << data.propPositions.size() << "\n"; // 道具数量
-    for (int i = 0; i < data.propPositions.size(); ++i)
-        out << data.propPositions[i].x() << " " << data.propPositions[i].y() << " " << data.propTypes[i] << "\n";
-    return true;
+    return file.commit();
 }
 
-// 从文件加载游戏
+// 从旧版文本存档加载游戏
 // path: 存档文件路径
 // data: 用于存储加载的游戏数据
-bool loadGame(const QString& path, SaveData& data) {
+static bool loadTextGame(const QString& path, SaveData& data) {
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
     QTextStream in(&file);
@@ -66,17 +198,17 @@ bool loadGame(const QString& path, SaveData& data) {
     in >> data.rows >> data.cols;
     // 读取方块贴图ID
     in >> data.blockTextureIds[0] >> data.blockTextureIds[1] >> data.blockTextureIds[2];
-    // 初始化方块矩阵
-    data.blockForms = QVector<QVector<int>>(data.rows, QVector<int>(data.cols));
-    data.blockStates = QVector<QVector<int>>(data.rows, QVector<int>(data.cols));
+    if (data.rows <= 0 || data.cols <= 0 || data.rows > saveMaxSide || data.cols > saveMaxSide) return false;
     // 读取方块形状矩阵
-    for (int i = 0; i < data.rows; ++i)
-        for (int j = 0; j < data.cols; ++j)
-            in >> data.blockForms[i][j];
-    // 读取方块状态矩阵
-    for (int i = 0; i < data.rows; ++i)
-        for (int j = 0; j < data.cols; ++j)
-            in >> data.blockStates[i][j];
+    QVector<int> forms(data.rows * data.cols);
+    for (int& form : forms) in >> form;
+    // 读取方块状态矩阵，与形状合并为方块表
+    data.cells = QByteArray(data.rows * data.cols, Qt::Uninitialized);
+    for (int i = 0; i < forms.size(); ++i) {
+        int state;
+        in >> state;
+        data.cells[i] = char(packBlock(forms[i], state));
+    }
     // 读取道具信息
     int propCount;
     in >> propCount;
@@ -88,10 +220,26 @@ bool loadGame(const QString& path, SaveData& data) {
         data.propPositions.append(QPoint(px, py));
         data.propTypes.append(ptype);
     }
-    return true;
+    return in.status() == QTextStream::Ok;
 }
 
-
-
-
-
+// 从文件加载游戏
+// path: 存档文件路径
+// data: 用于存储加载的游戏数据
+bool loadGame(const QString& path, SaveData& data) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    if (file.peek(4) == QByteArray(saveMagic, 4)) {
+        // 映射整个文件，校验和解码直接读取映射的页面
+        const qint64 size = file.size();
+        if (size > INT_MAX) return false;
+        if (uchar* mapped = file.map(0, size)) {
+            bool ok = decodeSave(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), int(size)), data);
+            file.unmap(mapped);
+            return ok;
+        }
+        return decodeSave(file.readAll(), data);
+    }
+    file.close();
+    return loadTextGame(path, data);
+}
@@ -1,9 +1,11 @@
 #pragma once
 #include <QString>
+#include <QByteArray>
 #include <QVector>
 #include <QPoint>
 #include <array>
 #include "item.h"
+#include "block.h"
 
 // 游戏模式枚举
 // 定义游戏的两种模式
@@ -23,29 +25,51 @@ struct SaveData {
     int cols = 14;                    // 地图列数
     QVector<QPoint> propPositions;    // 道具位置列表
     QVector<int> propTypes;           // 道具类型列表
-    QVector<QVector<int>> blockForms; // 方块形状矩阵（14x14）
-    QVector<QVector<int>> blockStates;// 方块状态矩阵（14x14）
+    QByteArray cells;                 // 方块表，每格一个字节（见packBlock），按行存储
     std::array<int, 3> blockTextureIds; // 本局使用的三个方块贴图编号
+
+    // 获取方块形状
+    // row: 行号  col: 列号
+    int formAt(int row, int col) const { return packedForm(uchar(cells[row * cols + col])); }
+
+    // 获取方块状态
+    // row: 行号  col: 列号
+    int stateAt(int row, int col) const { return packedState(uchar(cells[row * cols + col])); }
 };
 
+// 编码二进制存档
+// data: 要保存的游戏数据
+// 返回完整的存档字节（含文件头和校验和）
+// 格式（小端）：
+// 1. 文件头："QLNK"、版本号、模式、时间、分数、玩家位置、地图大小、贴图编号
+// 2. 方块表：encodeBoard按密度压缩后的数据，前缀4字节长度
+// 3. 道具表：道具数量，随后每个道具的位置和类型
+// 4. 前面所有字节的CRC-32
+QByteArray encodeSave(const SaveData& data);
+
+// 解码二进制存档
+// bytes: 存档字节
+// data: 用于存储解码的游戏数据
+// 返回存档是否有效
+// 一次遍历完成校验：魔数、版本、长度、CRC和各字段取值范围，
+// 任何一项不符（如文件被截断）都返回false且不修改data
+bool decodeSave(const QByteArray& bytes, SaveData& data);
+
 // 保存游戏到文件
 // path: 存档文件路径
 // data: 要保存的游戏数据
 // 返回保存是否成功
-// 将游戏状态保存到指定的文本文件中：
-// 1. 保存游戏模式、时间、分数
-// 2. 保存玩家位置
-// 3. 保存方块形状和状态矩阵
-// 4. 保存道具信息
+// 以二进制格式写入，先写临时文件再原子替换，写入中断不会损坏旧存档
 bool saveGame(const QString& path, const SaveData& data);
 
 // 从文件加载游戏
 // path: 存档文件路径
 // data: 用于存储加载的游戏数据
 // 返回加载是否成功
-// 从指定的文本文件中读取游戏状态：
+// 以"QLNK"开头的文件通过内存映射直接解码，方块表直接从映射的字节解出；
+// 否则按旧版文本格式读取：
 // 1. 读取游戏模式、时间、分数
 // 2. 读取玩家位置
 // 3. 读取方块形状和状态矩阵
 // 4. 读取道具信息
-bool loadGame(const QString& path, SaveData& data);
\ No newline at end of file
+bool loadGame(const QString& path, SaveData& data);
@@ -1,9 +1,44 @@
 #include "menu.h"
+#include "replay.h"
+#include "replayviewer.h"
 #include <QtWidgets/QApplication>
+#include <cstdio>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    // --replay <文件>：无窗口全速重放录像，校验最终分数和棋盘，一致时返回0
+    if (argc == 3 && strcmp(argv[1], "--replay") == 0) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        QApplication app(argc, argv);
+        app.setApplicationName("QLink");
+        Replay replay;
+        QString error;
+        if (!loadReplay(QString::fromLocal8Bit(argv[2]), replay, &error)) {
+            fprintf(stderr, "无法读取重放文件: %s（%s）\n", argv[2], qPrintable(error));
+            return 2;
+        }
+        ReplayResult result = Replayer::run(replay);
+        printf("%d events, %lld ms, score %d:%d (recorded %d:%d), board %016llx (recorded %016llx): %s\n",
+               int(replay.events.size()), (long long)result.elapsedMs, result.score1, result.score2,
+               replay.score1, replay.score2, (unsigned long long)result.boardHash,
+               (unsigned long long)replay.boardHash, result.matched ? "OK" : "MISMATCH");
+        return result.matched ? 0 : 1;
+    }
     QApplication app(argc, argv);
+    app.setApplicationName("QLink"); // 决定自动存档所在的应用数据目录
+    // --view-replay <文件>：打开录像回放窗口
+    if (argc == 3 && strcmp(argv[1], "--view-replay") == 0) {
+        Replay replay;
+        QString error;
+        if (!loadReplay(QString::fromLocal8Bit(argv[2]), replay, &error)) {
+            fprintf(stderr, "无法读取重放文件: %s（%s）\n", argv[2], qPrintable(error));
+            return 2;
+        }
+        ReplayViewer viewer(replay);
+        viewer.show();
+        return app.exec();
+    }
     Menu window;
     window.show();
     return app.exec();
@@ -2,12 +2,18 @@
 #include <QPalette>
 #include <QMediaPlayer>
 #include <QAudioOutput>
+#include <QPainter>
+#include <QResizeEvent>
 #include "menu.h"
 #include "simplemode.h"
 #include "duomode.h"
 #include "load.h"
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QFile>
+#include <QTimer>
+#include "savebrowser.h"
+#include "savelibrary.h"
 
 // 主菜单构造函数
 // parent: 父窗口指针
@@ -18,7 +24,9 @@ Menu::Menu(QWidget *parent)
     ui->setupUi(this);
     setWindowFlags(windowFlags() & ~Qt::WindowCloseButtonHint);
     ui->playControlBtn->setStyleSheet("QPushButton{border-image: url(:/images/images/icon.png);}");
-    setStyleSheet("Menu { background-image: url(:/images/images/background.png); }");
+    // 背景图只解码一次，缩放后缓存，绘制时整窗覆盖
+    backgroundSource = QPixmap(":/images/images/background.png");
+    setAttribute(Qt::WA_OpaquePaintEvent);
     ui->appTitle->setStyleSheet("QLabel { color: rgb(147, 218, 100); }");
     ui->appTitle2->setStyleSheet("QLabel { color: rgba(255,255,255,204); }");
     ui->simpleModeBtn->setStyleSheet("color: rgb(147, 218, 100);");
@@ -36,6 +44,8 @@ Menu::Menu(QWidget *parent)
     connect(ui->simpleModeBtn, &QPushButton::clicked, this, &Menu::simpleModeSlot);
     connect(ui->duoModeBtn, &QPushButton::clicked, this, &Menu::duoModeSlot);
     connect(ui->loadBtn, &QPushButton::clicked, this, &Menu::loadSlot);
+    QTimer::singleShot(0, this, &Menu::restoreAutosaveSlot);
+    SaveLibrary::instance(); // 提前读取存档索引并开始后台扫描
 }
 
 // 主菜单析构函数
@@ -46,6 +56,24 @@ Menu::~Menu()
     delete ui;
 }
 
+// 绘制事件
+// 直接贴上按窗口尺寸缓存的背景图
+void Menu::paintEvent(QPaintEvent* event)
+{
+    if (!qFuzzyCompare(background.devicePixelRatio(), devicePixelRatioF()))
+        background = scaledBackground(backgroundSource, size(), devicePixelRatioF());
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, background);
+}
+
+// 窗口尺寸变化事件
+// 按新的窗口尺寸重新缩放背景图
+void Menu::resizeEvent(QResizeEvent* event)
+{
+    QMainWindow::resizeEvent(event);
+    background = scaledBackground(backgroundSource, size(), devicePixelRatioF());
+}
+
 // 音乐播放控制函数
 // 控制背景音乐的播放/暂停状态
 void Menu::playControlSlot()
@@ -58,10 +86,11 @@ void Menu::playControlSlot()
 }
 
 // 单机模式启动函数
-// 创建并显示单机模式游戏窗口
+// 从流水线取出预先发好的棋盘，创建并显示单机模式游戏窗口
 void Menu::simpleModeSlot()
 {
-    SimpleMode* simpleModeWindow = new SimpleMode(this);
+    const PreparedBoard board = boards.take();
+    SimpleMode* simpleModeWindow = new SimpleMode(this, nullptr, board.seed, false, &board);
     connect(simpleModeWindow, &SimpleMode::exitToMenu, this, [this, simpleModeWindow]() {
         this->show();
         simpleModeWindow->deleteLater();
@@ -70,10 +99,11 @@ void Menu::simpleModeSlot()
 }
 
 // 双人模式启动函数
-// 创建并显示双人模式游戏窗口
+// 从流水线取出预先发好的棋盘，创建并显示双人模式游戏窗口
 void Menu::duoModeSlot()
 {
-    DuoMode* duoModeWindow = new DuoMode(this);
+    const PreparedBoard board = boards.take();
+    DuoMode* duoModeWindow = new DuoMode(this, nullptr, board.seed, false, &board);
     connect(duoModeWindow, &DuoMode::exitToMenu, this, [this, duoModeWindow]() {
         this->show();
         duoModeWindow->deleteLater();
@@ -84,13 +114,37 @@ void Menu::duoModeSlot()
 // 读取存档函数
 // 读取游戏存档并启动对应的游戏模式
 void Menu::loadSlot() {
-    QString path = QFileDialog::getOpenFileName(this, "读取存档", "", "存档文件 (*.txt)");
-    if (path.isEmpty()) return;
+    SaveBrowser browser(this);
+    if (browser.exec() != QDialog::Accepted) return;
+    QString path = browser.selectedPath();
     SaveData data;
     if (!loadGame(path, data)) {
         QMessageBox::warning(this, "错误", "存档读取失败！");
         return;
     }
+    openSave(data);
+}
+
+// 恢复自动存档函数
+// 游戏正常结束或主动退出时自动存档会被删除，启动时仍存在说明上次异常退出
+void Menu::restoreAutosaveSlot() {
+    for (GameMode mode : {GameMode::Single, GameMode::Duo}) {
+        QString path = AutoSaver::pathFor(mode);
+        if (!QFile::exists(path)) continue;
+        SaveData data;
+        if (AutoSaver::restore(path, data) && data.mode == mode &&
+            QMessageBox::question(this, "恢复游戏", QString("检测到上次未正常结束的%1游戏，是否恢复？").arg(mode == GameMode::Single ? "单人" : "双人")) == QMessageBox::Yes) {
+            openSave(data);
+            return;
+        }
+        QFile::remove(path + ".journal");
+        QFile::remove(path);
+    }
+}
+
+// 按存档启动游戏
+// data: 已读取的存档数据
+void Menu::openSave(const SaveData& data) {
     if (data.mode == GameMode::Single) {
         SimpleMode* simpleModeWindow = new SimpleMode(this, &data);
         connect(simpleModeWindow, &SimpleMode::exitToMenu, this, [this, simpleModeWindow]() {
@@ -6,6 +6,9 @@
 #include "simplemode.h"
 #include "duomode.h"
 #include "load.h"
+#include "texturecache.h"
+#include "autosaver.h"
+#include "boardpipeline.h"
 #include <QFileDialog>
 #include <QMessageBox>
 
@@ -47,8 +50,31 @@ private slots:
 	// 打开文件对话框选择存档文件，并加载游戏状态
 	void loadSlot();
 
+	// 恢复自动存档槽函数
+	// 启动时检查上次未正常结束的游戏，询问是否恢复
+	void restoreAutosaveSlot();
+
+protected:
+    // 重写绘制事件
+    // event: 绘制事件指针
+    // 直接贴上缓存的背景图
+    void paintEvent(QPaintEvent* event) override;
+
+    // 重写窗口尺寸变化事件
+    // event: 尺寸变化事件指针
+    // 按新的窗口尺寸重新缩放背景图
+    void resizeEvent(QResizeEvent* event) override;
+
 private:
+    // 按存档启动游戏
+    // data: 已读取的存档数据
+    // 根据存档模式创建对应的游戏窗口
+    void openSave(const SaveData& data);
+
     Ui::MenuClass *ui;        // UI界面指针，管理菜单界面的所有控件
     QMediaPlayer* mediaPlayer; // 媒体播放器指针，用于播放背景音乐
+    QPixmap backgroundSource;  // 原始背景图，只解码一次
+    QPixmap background;        // 按窗口尺寸缩放后的背景图
+    BoardPipeline boards{boardRows, boardCols, boardForms}; // 后台预先发好的开局棋盘
 };
 
@@ -0,0 +1,174 @@
+#include "movejournal.h"
+#include "block.h"
+#include <QtEndian>
+
+// 按小端追加一个整数
+template<typename T>
+static void append(QByteArray& out, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+// 追加一个地图坐标
+static void appendPoint(QByteArray& out, const QPoint& pos) {
+    append<qint16>(out, pos.x());
+    append<qint16>(out, pos.y());
+}
+
+// 写入一条记录的类型字节
+void MoveJournal::begin(JournalOp op)
+{
+    pending.append(char(op));
+}
+
+// 记录一次消除
+void MoveJournal::recordEliminate(const QPoint& a, const QPoint& b, int playerId)
+{
+    begin(JournalOp::Eliminate);
+    appendPoint(pending, a);
+    appendPoint(pending, b);
+    append<quint8>(pending, playerId);
+}
+
+// 记录一次洗牌
+void MoveJournal::recordShuffle(quint32 seed)
+{
+    begin(JournalOp::Shuffle);
+    append<quint32>(pending, seed);
+}
+
+// 记录生成道具
+void MoveJournal::recordPropSpawn(const QPoint& pos, ItemType type)
+{
+    begin(JournalOp::PropSpawn);
+    appendPoint(pending, pos);
+    append<quint8>(pending, static_cast<quint8>(type));
+}
+
+// 记录拾取道具
+void MoveJournal::recordPropPickup(const QPoint& pos)
+{
+    begin(JournalOp::PropPickup);
+    appendPoint(pending, pos);
+}
+
+// 记录玩家位置
+void MoveJournal::recordMove(int playerId, const QPoint& pos)
+{
+    movePos[playerId - 1] = pos;
+}
+
+// 记录剩余时间
+void MoveJournal::recordTime(int seconds)
+{
+    timeLeft = seconds;
+}
+
+// 记录一次状态变化
+// event: 状态变化
+// 分数由消除记录重新计算，道具效果不写入存档，都不需要记录
+void MoveJournal::record(const GameEvent& event)
+{
+    switch (event.type) {
+        case GameEventType::CellsCleared: recordEliminate(event.a, event.b, event.playerId); break;
+        case GameEventType::PlayerMoved: recordMove(event.playerId, event.a); break;
+        case GameEventType::PropSpawned: recordPropSpawn(event.a, event.item()); break;
+        case GameEventType::PropCollected: recordPropPickup(event.a); break;
+        case GameEventType::Shuffled: recordShuffle(static_cast<quint32>(event.value)); break;
+        case GameEventType::TimeChanged: recordTime(event.value); break;
+        case GameEventType::BoardReset:
+            // 整体替换后会写完整快照，这里只同步最新位置和时间，之后的变化与之比较
+            recordMove(1, event.a);
+            recordMove(2, event.b);
+            recordTime(event.value);
+            break;
+        default: break;
+    }
+}
+
+// 取出新增的记录
+QByteArray MoveJournal::takePending()
+{
+    for (int i = 0; i < 2; ++i) {
+        if (movePos[i] == writtenPos[i]) continue;
+        begin(JournalOp::Move);
+        append<quint8>(pending, i + 1);
+        appendPoint(pending, movePos[i]);
+        writtenPos[i] = movePos[i];
+    }
+    if (timeLeft != writtenTime) {
+        begin(JournalOp::Time);
+        append<qint32>(pending, timeLeft);
+        writtenTime = timeLeft;
+    }
+    QByteArray records = pending;
+    pending.clear();
+    return records;
+}
+
+// 在存档数据上重放日志
+bool MoveJournal::replay(const QByteArray& journal, SaveData& data)
+{
+    static const int payloadSize[] = {0, 9, 4, 5, 4, 5, 4}; // 各类型记录除类型字节外的长度
+    const char* p = journal.constData();
+    const char* end = p + journal.size();
+    auto takePoint = [&p]() {
+        int x = qFromLittleEndian<qint16>(p);
+        int y = qFromLittleEndian<qint16>(p + 2);
+        p += 4;
+        return QPoint(x, y);
+    };
+    auto inBoard = [&data](const QPoint& pos) {
+        return pos.x() >= 0 && pos.x() < data.cols && pos.y() >= 0 && pos.y() < data.rows;
+    };
+    while (p < end) {
+        quint8 op = quint8(*p);
+        if (op < 1 || op > 6) return false;
+        if (end - p - 1 < payloadSize[op]) return false; // 末尾记录写到一半
+        ++p;
+        switch (static_cast<JournalOp>(op)) {
+        case JournalOp::Eliminate: {
+            QPoint a = takePoint(), b = takePoint();
+            int playerId = quint8(*p++);
+            if (!inBoard(a) || !inBoard(b)) return false;
+            for (const QPoint& pos : {a, b}) {
+                char& cell = data.cells[pos.y() * data.cols + pos.x()];
+                cell = char(packBlock(packedForm(uchar(cell)), 0));
+            }
+            (playerId == 2 ? data.score2 : data.score1) += 2;
+            break;
+        }
+        case JournalOp::Shuffle:
+            shuffleCells(data.cells, qFromLittleEndian<quint32>(p));
+            p += 4;
+            break;
+        case JournalOp::PropSpawn: {
+            QPoint pos = takePoint();
+            int type = quint8(*p++);
+            if (!inBoard(pos) || type > static_cast<int>(ItemType::Dizzy)) return false;
+            data.propPositions.append(pos);
+            data.propTypes.append(type);
+            break;
+        }
+        case JournalOp::PropPickup: {
+            int index = data.propPositions.indexOf(takePoint());
+            if (index >= 0) {
+                data.propPositions.remove(index);
+                data.propTypes.remove(index);
+            }
+            break;
+        }
+        case JournalOp::Move: {
+            int playerId = quint8(*p++);
+            (playerId == 2 ? data.player2Pos : data.player1Pos) = takePoint();
+            break;
+        }
+        case JournalOp::Time:
+            data.timeLeft = qFromLittleEndian<qint32>(p);
+            p += 4;
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <QByteArray>
+#include <QPoint>
+#include "item.h"
+#include "load.h"
+#include "gameevent.h"
+
+// 日志记录类型
+enum class JournalOp : quint8 {
+    Eliminate = 1,  // 消除一对方块：两个方块位置、得分玩家
+    Shuffle,        // 洗牌：随机种子
+    PropSpawn,      // 生成道具：位置、类型
+    PropPickup,     // 拾取道具：位置
+    Move,           // 玩家位置：玩家编号、位置
+    Time            // 剩余时间
+};
+
+// 只追加的对局日志
+// 游戏过程中把每次状态变化编码为几个字节，自动存档时只需追加新增的记录
+// 恢复时在最近一次完整快照上按顺序重放日志即可还原对局
+// 玩家移动和剩余时间变化频繁，只在取出记录时写入最新值
+class MoveJournal
+{
+public:
+    // 记录一次消除
+    // a, b: 两个方块的地图坐标
+    // playerId: 得分的玩家编号（1或2）
+    void recordEliminate(const QPoint& a, const QPoint& b, int playerId);
+
+    // 记录一次洗牌
+    // seed: 洗牌使用的随机种子
+    void recordShuffle(quint32 seed);
+
+    // 记录生成道具
+    // pos: 道具地图坐标
+    // type: 道具类型
+    void recordPropSpawn(const QPoint& pos, ItemType type);
+
+    // 记录拾取道具
+    // pos: 道具地图坐标
+    void recordPropPickup(const QPoint& pos);
+
+    // 记录玩家位置
+    // playerId: 玩家编号（1或2）
+    // pos: 玩家地图坐标
+    // 只保留最新位置，取出记录时与上次写入的位置不同才写入
+    void recordMove(int playerId, const QPoint& pos);
+
+    // 记录剩余时间
+    // seconds: 剩余时间（秒）
+    // 只保留最新值，取出记录时与上次写入的值不同才写入
+    void recordTime(int seconds);
+
+    // 记录一次状态变化
+    // event: 游戏逻辑发出的状态变化，与存档无关的变化（道具效果、分数）被忽略
+    // 作为对局状态变化的订阅者使用，游戏逻辑不必逐个调用上面的记录函数
+    void record(const GameEvent& event);
+
+    // 取出新增的记录
+    // 返回自上次取出以来的全部记录，包括合并后的玩家位置和剩余时间
+    QByteArray takePending();
+
+    // 在存档数据上重放日志
+    // journal: 日志字节
+    // data: 作为基准的完整快照，重放结果直接写回
+    // 返回日志是否完整；末尾被截断的记录会被忽略，之前的记录仍然生效
+    static bool replay(const QByteArray& journal, SaveData& data);
+
+private:
+    // 写入一条记录的类型字节
+    void begin(JournalOp op);
+
+    QByteArray pending;               // 尚未取出的记录
+    QPoint movePos[2] = {QPoint(-1, -1), QPoint(-1, -1)};    // 两个玩家的最新位置
+    QPoint writtenPos[2] = {QPoint(-1, -1), QPoint(-1, -1)}; // 两个玩家上次写入的位置
+    int timeLeft = -1;                // 最新剩余时间
+    int writtenTime = -1;             // 上次写入的剩余时间
+};
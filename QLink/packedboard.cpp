@@ -0,0 +1,78 @@
+#include "packedboard.h"
+#include "block.h"
+#include <algorithm>
+
+// 格子是否为空
+bool PackedBoard::isEmpty(int x, int y) const
+{
+    return packedState(uchar(cells[y * cols + x])) == 0;
+}
+
+// 格子上方块的形状
+int PackedBoard::form(int x, int y) const
+{
+    return packedForm(uchar(cells[y * cols + x]));
+}
+
+// 判断两格是否可直线连接
+bool PackedBoard::canLinkInLine(int x1, int y1, int x2, int y2) const
+{
+    if (x1 == x2) {
+        for (int y = std::min(y1, y2) + 1; y < std::max(y1, y2); ++y)
+            if (!isEmpty(x1, y)) return false;
+        return true;
+    }
+    if (y1 == y2) {
+        for (int x = std::min(x1, x2) + 1; x < std::max(x1, x2); ++x)
+            if (!isEmpty(x, y1)) return false;
+        return true;
+    }
+    return false;
+}
+
+// 判断两格是否可通过一个拐点连接
+bool PackedBoard::canLinkWithOneCorner(int x1, int y1, int x2, int y2, QVector<QPoint>* path) const
+{
+    if (isEmpty(x1, y2) && canLinkInLine(x1, y1, x1, y2) && canLinkInLine(x1, y2, x2, y2)) {
+        if (path) *path = {QPoint(x1, y1), QPoint(x1, y2), QPoint(x2, y2)};
+        return true;
+    }
+    if (isEmpty(x2, y1) && canLinkInLine(x1, y1, x2, y1) && canLinkInLine(x2, y1, x2, y2)) {
+        if (path) *path = {QPoint(x1, y1), QPoint(x2, y1), QPoint(x2, y2)};
+        return true;
+    }
+    return false;
+}
+
+// 判断两格是否可通过两个拐点连接
+// 先找水平通道，再找竖直通道
+bool PackedBoard::canLinkWithTwoCorners(int x1, int y1, int x2, int y2, QVector<QPoint>* path) const
+{
+    for (int i = 0; i < rows; ++i) {
+        if (i == y1 || i == y2) continue;
+        if (isEmpty(x1, i) && isEmpty(x2, i) &&
+            canLinkInLine(x1, y1, x1, i) && canLinkInLine(x1, i, x2, i) && canLinkInLine(x2, i, x2, y2)) {
+            if (path) *path = {QPoint(x1, y1), QPoint(x1, i), QPoint(x2, i), QPoint(x2, y2)};
+            return true;
+        }
+    }
+    for (int j = 0; j < cols; ++j) {
+        if (j == x1 || j == x2) continue;
+        if (isEmpty(j, y1) && isEmpty(j, y2) &&
+            canLinkInLine(x1, y1, j, y1) && canLinkInLine(j, y1, j, y2) && canLinkInLine(j, y2, x2, y2)) {
+            if (path) *path = {QPoint(x1, y1), QPoint(j, y1), QPoint(j, y2), QPoint(x2, y2)};
+            return true;
+        }
+    }
+    return false;
+}
+
+// 判断两格是否可连接
+bool PackedBoard::canLink(int x1, int y1, int x2, int y2, QVector<QPoint>* path) const
+{
+    if (canLinkInLine(x1, y1, x2, y2)) {
+        if (path) *path = {QPoint(x1, y1), QPoint(x2, y2)};
+        return true;
+    }
+    return canLinkWithOneCorner(x1, y1, x2, y2, path) || canLinkWithTwoCorners(x1, y1, x2, y2, path);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <QByteArray>
+#include <QPoint>
+#include <QVector>
+
+// 压缩棋盘上的连线判定
+// 游戏窗口、后台Hint查找和开局校验共用这一份规则：最多两个拐点，路径只能经过空格子
+// 棋盘隐式共享，构造时只增加引用计数
+class PackedBoard
+{
+public:
+    // 构造函数
+    // cells: 压缩棋盘（见packBlock），按行存储
+    // rows, cols: 地图行数和列数
+    PackedBoard(const QByteArray& cells, int rows, int cols) : cells(cells), rows(rows), cols(cols) {}
+
+    // 格子是否为空（已消除或没有方块）
+    bool isEmpty(int x, int y) const;
+
+    // 格子上方块的形状
+    int form(int x, int y) const;
+
+    // 判断两格是否可直线连接，中间的格子都为空
+    bool canLinkInLine(int x1, int y1, int x2, int y2) const;
+
+    // 判断两格是否可通过一个拐点连接
+    // path: 可以为空，连接时写入起点、拐点和终点
+    bool canLinkWithOneCorner(int x1, int y1, int x2, int y2, QVector<QPoint>* path = nullptr) const;
+
+    // 判断两格是否可通过两个拐点连接
+    // path: 可以为空，连接时写入起点、两个拐点和终点
+    bool canLinkWithTwoCorners(int x1, int y1, int x2, int y2, QVector<QPoint>* path = nullptr) const;
+
+    // 判断两格是否可连接，依次尝试直线、一个拐点和两个拐点
+    // path: 可以为空，连接时写入经过的拐点
+    bool canLink(int x1, int y1, int x2, int y2, QVector<QPoint>* path = nullptr) const;
+
+private:
+    QByteArray cells; // 压缩棋盘
+    int rows, cols;   // 地图行数和列数
+};
@@ -0,0 +1,101 @@
+#include "proppool.h"
+
+// 清空所有道具并设置地图尺寸
+void PropPool::reset(int newRows, int newCols)
+{
+    clear();
+    rows = newRows;
+    cols = newCols;
+    grid.fill(PropHandle(), rows * cols);
+}
+
+// 清空所有道具
+// 使用中的槽位代数加一后挂回空闲链表
+void PropPool::clear()
+{
+    for (int owner : owners) {
+        Slot& slot = slotTable[owner];
+        slot.used = false;
+        ++slot.generation;
+        slot.index = freeHead;
+        freeHead = owner;
+    }
+    items.clear();
+    owners.clear();
+    grid.fill(PropHandle());
+}
+
+// 格子编号
+int PropPool::cellIndex(const QPoint& cell) const
+{
+    if (cell.x() < 0 || cell.x() >= cols || cell.y() < 0 || cell.y() >= rows) return -1;
+    return cell.y() * cols + cell.x();
+}
+
+// 放置道具
+// 优先复用空闲槽位，没有空闲槽位时才分配新槽位
+PropHandle PropPool::add(ItemType type, const QPoint& cell, const QRectF& rect, const QPixmap& pixmap)
+{
+    int index = cellIndex(cell);
+    if (index < 0 || !grid[index].isNull()) return PropHandle();
+    int owner = freeHead;
+    if (owner >= 0) {
+        freeHead = slotTable[owner].index;
+    } else {
+        owner = slotTable.size();
+        slotTable.append(Slot());
+    }
+    Slot& slot = slotTable[owner];
+    slot.used = true;
+    slot.index = items.size();
+    items.append(Item(type, cell, rect, pixmap));
+    owners.append(owner);
+    PropHandle handle;
+    handle.slot = owner;
+    handle.generation = slot.generation;
+    grid[index] = handle;
+    return handle;
+}
+
+// 回收道具
+// 把末尾的道具移到被回收的位置，只需更新它所在槽位的下标
+bool PropPool::remove(PropHandle handle)
+{
+    if (!get(handle)) return false;
+    Slot& slot = slotTable[handle.slot];
+    int pos = slot.index;
+    grid[cellIndex(items[pos].getMapPos())] = PropHandle();
+    int lastOwner = owners.last();
+    items[pos] = items.last();
+    owners[pos] = lastOwner;
+    slotTable[lastOwner].index = pos;
+    items.removeLast();
+    owners.removeLast();
+    slot.used = false;
+    ++slot.generation;
+    slot.index = freeHead;
+    freeHead = handle.slot;
+    return true;
+}
+
+// 按句柄获取道具
+Item* PropPool::get(PropHandle handle)
+{
+    if (handle.slot < 0 || handle.slot >= slotTable.size()) return nullptr;
+    const Slot& slot = slotTable[handle.slot];
+    if (!slot.used || slot.generation != handle.generation) return nullptr;
+    return &items[slot.index];
+}
+
+// 格子上道具的句柄
+PropHandle PropPool::handleAt(const QPoint& cell) const
+{
+    int index = cellIndex(cell);
+    return index < 0 ? PropHandle() : grid[index];
+}
+
+// 格子上的道具
+Item* PropPool::itemAt(const QPoint& cell)
+{
+    return get(handleAt(cell));
+}
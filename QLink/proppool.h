@@ -0,0 +1,78 @@
+#pragma once
+#include <QPoint>
+#include <QRectF>
+#include <QPixmap>
+#include <QVector>
+#include "item.h"
+
+// 道具句柄
+// 由槽位下标和槽位代数组成，槽位回收复用后代数变化，旧句柄不会指向新道具
+struct PropHandle {
+    int slot = -1;           // 槽位下标，-1为空句柄
+    quint32 generation = 0;  // 槽位代数
+
+    bool isNull() const { return slot < 0; }
+    bool operator==(const PropHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const PropHandle& other) const { return !(*this == other); }
+};
+
+// 道具池
+// 场上的道具按值紧凑存放，遍历只访问存在的道具；槽位表把句柄映射到数组下标，空出的槽位挂在空闲链表上复用
+// 另有按格子编号的句柄表，检查某格是否有道具只需查一次表
+// 拾取的道具立即回收，长时间对局中占用的内存只取决于同时存在的道具数量
+class PropPool
+{
+public:
+    // 清空所有道具并设置地图尺寸
+    // rows, cols: 地图行数和列数
+    void reset(int rows, int cols);
+
+    // 清空所有道具，地图尺寸不变
+    // 已分配的槽位和数组容量保留复用，旧句柄全部失效
+    void clear();
+
+    // 放置道具
+    // type: 道具类型
+    // cell: 地图坐标
+    // rect: 像素坐标矩形
+    // pixmap: 道具图标
+    // 返回新道具的句柄，格子超出地图或已有道具时返回空句柄
+    PropHandle add(ItemType type, const QPoint& cell, const QRectF& rect, const QPixmap& pixmap);
+
+    // 回收道具
+    // handle: 道具句柄
+    // 返回是否回收，句柄已失效时返回false
+    bool remove(PropHandle handle);
+
+    Item* get(PropHandle handle);                  // 按句柄获取道具，句柄失效时返回nullptr
+    PropHandle handleAt(const QPoint& cell) const; // 格子上道具的句柄，没有道具时返回空句柄
+    Item* itemAt(const QPoint& cell);              // 格子上的道具，没有道具时返回nullptr
+
+    int size() const { return items.size(); }                // 场上道具数量
+    bool isEmpty() const { return items.isEmpty(); }         // 场上是否没有道具
+    int slotCount() const { return slotTable.size(); }       // 已分配的槽位数量
+    const Item& at(int i) const { return items[i]; }         // 按数组顺序获取道具
+
+    QVector<Item>::iterator begin() { return items.begin(); }
+    QVector<Item>::iterator end() { return items.end(); }
+    QVector<Item>::const_iterator begin() const { return items.begin(); }
+    QVector<Item>::const_iterator end() const { return items.end(); }
+
+private:
+    // 槽位
+    struct Slot {
+        int index = -1;          // 使用中为道具在items中的下标，空闲时为空闲链表中的下一个槽位
+        quint32 generation = 0;  // 每次回收加一
+        bool used = false;       // 是否使用中
+    };
+
+    // 格子编号，超出地图时返回-1
+    int cellIndex(const QPoint& cell) const;
+
+    int rows = 0, cols = 0;        // 地图行数和列数
+    QVector<Item> items;           // 场上的道具，顺序随放置和回收变化
+    QVector<int> owners;           // 每个道具所在的槽位，与items一一对应
+    QVector<Slot> slotTable;       // 槽位表
+    int freeHead = -1;             // 空闲链表头，-1表示没有空闲槽位
+    QVector<PropHandle> grid;      // 每格道具的句柄
+};
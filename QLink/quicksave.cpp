@@ -0,0 +1,73 @@
+#include "quicksave.h"
+#include <QDir>
+#include <QStandardPaths>
+
+// 从存档数据取出局面
+// data: 存档数据
+GameSnapshot GameSnapshot::fromSaveData(const SaveData& data)
+{
+    GameSnapshot snapshot;
+    snapshot.rows = data.rows;
+    snapshot.cols = data.cols;
+    snapshot.cells = data.cells;
+    snapshot.timeLeft = data.timeLeft;
+    snapshot.score1 = data.score1;
+    snapshot.score2 = data.score2;
+    snapshot.player1 = data.player1Pos;
+    snapshot.player2 = data.player2Pos;
+    snapshot.propPositions = data.propPositions;
+    snapshot.propTypes = data.propTypes;
+    return snapshot;
+}
+
+// 构造函数
+// mode: 游戏模式
+QuickSlots::QuickSlots(GameMode mode)
+{
+    if (!qEnvironmentVariableIsSet("QLINK_QUICKSAVE_DISK")) return;
+    for (int slot = 0; slot < quickSlotCount; ++slot)
+        mirrors[slot] = new AutoSaver(pathFor(mode, slot));
+}
+
+// 析构函数
+QuickSlots::~QuickSlots()
+{
+    for (AutoSaver* mirror : mirrors) delete mirror;
+}
+
+// 保存快照
+// slot: 存档槽编号
+// snapshot: 局面快照
+void QuickSlots::store(int slot, const GameSnapshot& snapshot)
+{
+    if (slot < 0 || slot >= quickSlotCount) return;
+    snapshots[slot] = snapshot;
+    filled[slot] = true;
+}
+
+// 把存档数据镜像到磁盘
+// slot: 存档槽编号
+// data: 存档数据
+void QuickSlots::mirror(int slot, const SaveData& data)
+{
+    if (slot < 0 || slot >= quickSlotCount || !mirrors[slot]) return;
+    mirrors[slot]->submit(data);
+}
+
+// 获取快照
+// slot: 存档槽编号
+const GameSnapshot* QuickSlots::snapshot(int slot) const
+{
+    if (slot < 0 || slot >= quickSlotCount || !filled[slot]) return nullptr;
+    return &snapshots[slot];
+}
+
+// 获取磁盘镜像路径
+// mode: 游戏模式
+// slot: 存档槽编号
+QString QuickSlots::pathFor(GameMode mode, int slot)
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + QString("/quicksave-%1-%2.qsav").arg(mode == GameMode::Single ? "single" : "duo").arg(slot + 1);
+}
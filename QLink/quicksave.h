@@ -0,0 +1,74 @@
+#pragma once
+#include <QPoint>
+#include <array>
+#include "load.h"
+#include "autosaver.h"
+#include "effectsystem.h"
+#include "gamescheduler.h"
+
+const int quickSlotCount = 2; // 快速存档槽数量：F5/F9使用第一个，Shift+F5/Shift+F9使用第二个
+
+// 游戏局面快照
+// 直接保存对局引擎的紧凑状态：压缩棋盘、分数、时间、玩家位置、道具、道具效果和激活的方块
+// 不经过存档数据；成员都是隐式共享的Qt容器，复制快照只增加引用计数
+struct GameSnapshot {
+    int rows = 0, cols = 0;                   // 地图行数和列数
+    QByteArray cells;                         // 压缩棋盘（见packBlock），按行存储
+    int timeLeft = 0;                         // 剩余时间
+    int score1 = 0, score2 = 0;               // 两个玩家的分数
+    QPoint player1{-1, -1}, player2{-1, -1};  // 两个玩家的位置，单人模式玩家2为(-1,-1)
+    QVector<QPoint> propPositions;            // 道具位置
+    QVector<int> propTypes;                   // 道具类型
+    quint32 flags = 0;                        // 道具效果，ReplayKeyframeFlag按位组合
+    QPoint active1{-1, -1}, active2{-1, -1};  // 两个玩家激活的方块，没有时为(-1,-1)
+    QVector<StatusEffect> effects;            // 道具效果记录，到期时间换算为剩余时间
+    QVector<ScheduledTimer> timers;           // 倒计时、道具生成等定时事件的剩余时间，关键帧为空
+
+    // 从存档数据取出局面，读档和关键帧使用
+    // data: 存档数据
+    static GameSnapshot fromSaveData(const SaveData& data);
+};
+
+// 快速存档槽
+// 快照只保存在内存中，保存和读取都不经过编码和文件；可选在后台把存档数据镜像到磁盘
+class QuickSlots
+{
+public:
+    // 构造函数
+    // mode: 游戏模式，决定磁盘镜像的文件名
+    // 设置了QLINK_QUICKSAVE_DISK环境变量时把每次快速存档镜像到应用数据目录
+    explicit QuickSlots(GameMode mode);
+
+    // 析构函数
+    // 等待磁盘镜像写完
+    ~QuickSlots();
+
+    // 保存快照
+    // slot: 存档槽编号
+    // snapshot: 局面快照
+    void store(int slot, const GameSnapshot& snapshot);
+
+    // 是否开启了磁盘镜像，没有开启时不必生成存档数据
+    bool isMirrored() const { return mirrors[0] != nullptr; }
+
+    // 把存档数据镜像到磁盘
+    // slot: 存档槽编号
+    // data: 与快照对应的存档数据
+    // 编码和写盘都在后台线程，未开启镜像时不做任何事
+    void mirror(int slot, const SaveData& data);
+
+    // 获取快照
+    // slot: 存档槽编号
+    // 返回存档槽中的快照，槽为空时返回nullptr
+    const GameSnapshot* snapshot(int slot) const;
+
+    // 获取磁盘镜像路径
+    // mode: 游戏模式
+    // slot: 存档槽编号
+    static QString pathFor(GameMode mode, int slot);
+
+private:
+    std::array<GameSnapshot, quickSlotCount> snapshots; // 各存档槽的快照
+    std::array<bool, quickSlotCount> filled{};          // 各存档槽是否已保存
+    std::array<AutoSaver*, quickSlotCount> mirrors{};   // 后台磁盘镜像，未开启时为nullptr
+};
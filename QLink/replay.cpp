@@ -0,0 +1,298 @@
+#include "replay.h"
+#include "simplemode.h"
+#include "duomode.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+static const char replayMagic[4] = {'Q', 'R', 'P', 'L'}; // 重放文件魔数
+static const quint16 replayVersion = 3;                 // 重放文件版本号，道具改从空闲格抽取后旧版录像无法复现，只读取当前版本
+static const int replayHeaderSize = 16;                 // 文件头字节数
+static const int replayEventSize = 9;                   // 每条事件的字节数
+static const int replayKeyframeSize = 32;               // 每个关键帧除存档外的字节数
+static const int replayFooterSize = 16;                 // 文件尾字节数
+
+// 按小端追加一个整数
+template<typename T>
+static void append(QByteArray& out, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+// 按小端读取一个整数并前移读指针
+template<typename T>
+static T take(const char*& p) {
+    T value = qFromLittleEndian<T>(p);
+    p += sizeof(T);
+    return value;
+}
+
+// 保存重放文件
+// path: 文件路径
+// replay: 重放数据
+bool saveReplay(const QString& path, const Replay& replay) {
+    QByteArray bytes;
+    int keyframeBytes = 4;
+    for (const ReplayKeyframe& keyframe : replay.keyframes) keyframeBytes += replayKeyframeSize + keyframe.state.size();
+    bytes.reserve(replayHeaderSize + replay.events.size() * replayEventSize + keyframeBytes + replayFooterSize);
+    bytes.append(replayMagic, 4);
+    append<quint16>(bytes, replayVersion);
+    append<quint8>(bytes, replay.mode == GameMode::Single ? 0 : 1);
+    append<quint8>(bytes, 0);
+    append<quint32>(bytes, replay.seed);
+    append<quint32>(bytes, replay.events.size());
+    for (const ReplayEvent& event : replay.events) {
+        append<quint32>(bytes, event.time);
+        append<quint8>(bytes, static_cast<quint8>(event.type));
+        append<qint32>(bytes, event.value);
+    }
+    append<quint32>(bytes, replay.keyframes.size());
+    for (const ReplayKeyframe& keyframe : replay.keyframes) {
+        append<quint32>(bytes, keyframe.eventIndex);
+        append<quint32>(bytes, keyframe.time);
+        append<quint32>(bytes, keyframe.seed);
+        append<quint32>(bytes, keyframe.ticks);
+        append<quint32>(bytes, keyframe.flags);
+        append<qint16>(bytes, keyframe.active1.x());
+        append<qint16>(bytes, keyframe.active1.y());
+        append<qint16>(bytes, keyframe.active2.x());
+        append<qint16>(bytes, keyframe.active2.y());
+        append<quint32>(bytes, keyframe.state.size());
+        bytes.append(keyframe.state);
+    }
+    append<qint32>(bytes, replay.score1);
+    append<qint32>(bytes, replay.score2);
+    append<quint64>(bytes, replay.boardHash);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(bytes);
+    return file.commit();
+}
+
+// 读取并解析重放文件
+// reason: 失败时写入原因，格式错误以外的原因才需要改写
+static bool loadReplayData(const QString& path, Replay& replay, QString& reason) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        reason = "无法打开文件";
+        return false;
+    }
+    const QByteArray bytes = file.readAll();
+    if (bytes.size() < replayHeaderSize + replayFooterSize || memcmp(bytes.constData(), replayMagic, 4) != 0) return false;
+    const char* p = bytes.constData() + 4;
+    const char* end = bytes.constData() + bytes.size() - replayFooterSize;
+    const quint16 version = take<quint16>(p);
+    if (version != replayVersion) {
+        reason = version < replayVersion ? QString("版本%1的录像由旧版游戏录制，当前版本无法复现").arg(version)
+                                         : QString("版本%1的录像需要更新的游戏版本").arg(version);
+        return false;
+    }
+    quint8 mode = take<quint8>(p);
+    p += 1;
+    if (mode > 1) return false;
+    Replay result;
+    result.mode = mode == 0 ? GameMode::Single : GameMode::Duo;
+    result.seed = take<quint32>(p);
+    const quint32 count = take<quint32>(p);
+    if (qint64(count) * replayEventSize > end - p) return false;
+    result.events.resize(count);
+    for (ReplayEvent& event : result.events) {
+        event.time = take<quint32>(p);
+        event.type = static_cast<ReplayEventType>(take<quint8>(p));
+        event.value = take<qint32>(p);
+        if (event.type < ReplayEventType::Key || event.type > ReplayEventType::Tick) return false;
+    }
+    if (end - p < 4) return false;
+    const quint32 keyframeCount = take<quint32>(p);
+    if (qint64(keyframeCount) * replayKeyframeSize > end - p) return false;
+    result.keyframes.resize(keyframeCount);
+    quint32 lastIndex = 0;
+    for (ReplayKeyframe& keyframe : result.keyframes) {
+        if (end - p < replayKeyframeSize) return false;
+        keyframe.eventIndex = take<quint32>(p);
+        keyframe.time = take<quint32>(p);
+        keyframe.seed = take<quint32>(p);
+        keyframe.ticks = take<quint32>(p);
+        keyframe.flags = take<quint32>(p);
+        int x = take<qint16>(p);
+        keyframe.active1 = QPoint(x, take<qint16>(p));
+        x = take<qint16>(p);
+        keyframe.active2 = QPoint(x, take<qint16>(p));
+        const quint32 size = take<quint32>(p);
+        if (size > quint32(end - p)) return false;
+        // 关键帧必须按事件顺序排列，跳转时才能二分查找
+        if (keyframe.eventIndex > count || keyframe.eventIndex < lastIndex) return false;
+        lastIndex = keyframe.eventIndex;
+        keyframe.state = QByteArray(p, size);
+        p += size;
+    }
+    if (p != end) return false;
+    result.score1 = take<qint32>(p);
+    result.score2 = take<qint32>(p);
+    result.boardHash = take<quint64>(p);
+    replay = result;
+    return true;
+}
+
+// 读取重放文件
+// path: 文件路径
+// replay: 用于存储读取的重放数据
+// error: 可以为空，读取失败时写入原因
+bool loadReplay(const QString& path, Replay& replay, QString* error) {
+    QString reason = "文件被截断或格式不符";
+    bool ok = loadReplayData(path, replay, reason);
+    if (!ok && error) *error = reason;
+    return ok;
+}
+
+// 计算棋盘哈希
+// cells: 压缩棋盘
+quint64 boardHash(const QByteArray& cells) {
+    quint64 hash = 14695981039346656037ull;
+    for (char cell : cells) {
+        hash ^= uchar(cell);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 开始录制
+// mode: 游戏模式
+// seed: 对局随机种子
+void ReplayRecorder::start(GameMode mode, quint32 seed)
+{
+    replay = Replay();
+    replay.mode = mode;
+    replay.seed = seed;
+    recording = true;
+    clock.start();
+}
+
+// 追加一条事件
+void ReplayRecorder::record(ReplayEventType type, qint32 value)
+{
+    if (!recording) return;
+    replay.events.append(ReplayEvent{quint32(clock.elapsed()), type, value});
+}
+
+// 记录按键
+void ReplayRecorder::recordKey(int key)
+{
+    record(ReplayEventType::Key, key);
+}
+
+// 记录点击
+void ReplayRecorder::recordClick(const QPoint& cell)
+{
+    record(ReplayEventType::Click, (cell.y() << 16) | (cell.x() & 0xFFFF));
+}
+
+// 记录定时器触发
+void ReplayRecorder::recordTick(ReplayTick tick)
+{
+    record(ReplayEventType::Tick, static_cast<int>(tick));
+}
+
+// 记录关键帧
+// keyframe: 游戏窗口保存的状态
+void ReplayRecorder::recordKeyframe(ReplayKeyframe keyframe)
+{
+    if (!recording) return;
+    keyframe.eventIndex = replay.events.size();
+    keyframe.time = quint32(clock.elapsed());
+    replay.keyframes.append(keyframe);
+}
+
+// 结束录制并写入重放文件
+void ReplayRecorder::finish(int score1, int score2, const QByteArray& cells)
+{
+    if (!recording) return;
+    recording = false;
+    replay.score1 = score1;
+    replay.score2 = score2;
+    replay.boardHash = boardHash(cells);
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/replays";
+    QDir().mkpath(dir);
+    QString name = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + (replay.mode == GameMode::Single ? "-single" : "-duo") + ".qrpl";
+    saveReplay(dir + "/" + name, replay);
+}
+
+// 构造函数
+// replay: 重放数据
+Replayer::Replayer(const Replay& replay)
+    : data(replay)
+{
+    if (data.mode == GameMode::Single) {
+        simple = new SimpleMode(nullptr, nullptr, data.seed, true);
+        opening = simple->captureKeyframe();
+    } else {
+        duo = new DuoMode(nullptr, nullptr, data.seed, true);
+        opening = duo->captureKeyframe();
+    }
+}
+
+// 析构函数
+Replayer::~Replayer()
+{
+    delete simple;
+    delete duo;
+}
+
+// 获取游戏窗口
+QWidget* Replayer::view() const
+{
+    if (simple) return simple;
+    return duo;
+}
+
+// 执行一条事件
+void Replayer::apply(const ReplayEvent& event)
+{
+    if (simple) simple->applyReplayEvent(event);
+    else duo->applyReplayEvent(event);
+}
+
+// 跳转到指定时间
+// time: 距开局的毫秒数
+void Replayer::seek(quint32 time)
+{
+    // 时间不晚于目标的最后一个关键帧
+    auto it = std::upper_bound(data.keyframes.cbegin(), data.keyframes.cend(), time,
+                               [](quint32 t, const ReplayKeyframe& keyframe) { return t < keyframe.time; });
+    const ReplayKeyframe& keyframe = it == data.keyframes.cbegin() ? opening : *(it - 1);
+    if (time < current || nextEvent < int(keyframe.eventIndex)) {
+        if (simple) simple->restoreKeyframe(keyframe);
+        else duo->restoreKeyframe(keyframe);
+        nextEvent = keyframe.eventIndex;
+    }
+    while (nextEvent < data.events.size() && data.events[nextEvent].time <= time) apply(data.events[nextEvent++]);
+    current = time;
+}
+
+// 重放一局对局
+// replay: 重放数据
+ReplayResult Replayer::run(const Replay& replay)
+{
+    ReplayResult result;
+    QElapsedTimer timer;
+    timer.start();
+    Replayer replayer(replay);
+    for (const ReplayEvent& event : replay.events) replayer.apply(event);
+    if (replayer.simple) {
+        result.score1 = replayer.simple->score;
+        result.boardHash = boardHash(replayer.simple->packedBoard());
+    } else {
+        result.score1 = replayer.duo->score1;
+        result.score2 = replayer.duo->score2;
+        result.boardHash = boardHash(replayer.duo->packedBoard());
+    }
+    result.elapsedMs = timer.elapsed();
+    result.matched = result.score1 == replay.score1 && result.score2 == replay.score2 && result.boardHash == replay.boardHash;
+    return result;
+}
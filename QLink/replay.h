@@ -0,0 +1,203 @@
+#pragma once
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+#include "load.h"
+
+class SimpleMode;
+class DuoMode;
+class QWidget;
+
+const int replayKeyframeInterval = 10; // 关键帧间隔（倒计时次数，即游戏秒数）
+
+// 重放事件类型
+enum class ReplayEventType : quint8 {
+    Key = 1,    // 按键：value为Qt::Key
+    Click = 2,  // Flash道具下的鼠标点击：value为地图坐标，高16位y，低16位x
+    Tick = 3    // 定时器触发：value为ReplayTick
+};
+
+// 影响对局的定时器
+enum class ReplayTick : quint8 {
+    Progress,    // 每秒倒计时
+    Prop,        // 生成道具
+    HintEnd,     // Hint效果结束
+    FlashEnd,    // 玩家1 Flash效果结束
+    Freeze1End,  // 玩家1冻结结束
+    Freeze2End,  // 玩家2冻结结束
+    Dizzy1End,   // 玩家1眩晕结束
+    Dizzy2End,   // 玩家2眩晕结束
+    Flash2End,   // 玩家2 Flash效果结束
+    DeadShuffle, // 死局自动洗牌
+    DeadEnd      // 死局结束对局
+};
+
+// 一条重放事件
+struct ReplayEvent {
+    quint32 time;          // 距开局的毫秒数
+    ReplayEventType type;  // 事件类型
+    qint32 value;          // 事件参数
+
+    // 获取点击的地图坐标
+    QPoint cell() const { return QPoint(qint16(value & 0xFFFF), qint16(value >> 16)); }
+};
+
+// 关键帧中按位存储的道具效果
+enum ReplayKeyframeFlag : quint32 {
+    KeyframeHint = 1,     // Hint效果中
+    KeyframeFlash1 = 2,   // 玩家1 Flash效果中（单机模式只用这一位）
+    KeyframeFlash2 = 4,   // 玩家2 Flash效果中
+    KeyframeFreeze1 = 8,  // 玩家1被冻结
+    KeyframeFreeze2 = 16, // 玩家2被冻结
+    KeyframeDizzy1 = 32,  // 玩家1眩晕
+    KeyframeDizzy2 = 64   // 玩家2眩晕
+};
+
+// 重放关键帧
+// 对局每隔replayKeyframeInterval秒用新种子重置随机数，录制时在此保存完整状态
+// 跳转时恢复最近的关键帧，只模拟之后的事件
+struct ReplayKeyframe {
+    quint32 eventIndex = 0;  // 关键帧之后第一条事件的下标
+    quint32 time = 0;        // 距开局的毫秒数
+    quint32 seed = 0;        // 关键帧处重置的随机种子
+    quint32 ticks = 0;       // 已经过的倒计时次数
+    quint32 flags = 0;       // 道具效果，ReplayKeyframeFlag按位组合
+    QPoint active1{-1, -1}, active2{-1, -1}; // 两个玩家激活的方块，没有时为(-1,-1)
+    QByteArray state;        // encodeSave编码的存档，棋盘已压缩
+};
+
+// 一局对局的重放数据
+// 种子决定初始棋盘、道具和洗牌，事件序列决定其余一切，结尾记录用于校验的最终结果
+struct Replay {
+    GameMode mode = GameMode::Single; // 游戏模式
+    quint32 seed = 0;                 // 对局随机种子
+    QVector<ReplayEvent> events;      // 按时间排列的输入和定时器事件
+    QVector<ReplayKeyframe> keyframes; // 按时间排列的关键帧
+    int score1 = 0, score2 = 0;       // 最终分数
+    quint64 boardHash = 0;            // 最终棋盘哈希
+};
+
+// 保存重放文件
+// path: 文件路径
+// replay: 重放数据
+// 返回保存是否成功
+bool saveReplay(const QString& path, const Replay& replay);
+
+// 读取重放文件
+// path: 文件路径
+// replay: 用于存储读取的重放数据
+// error: 可以为空，读取失败时写入原因
+// 返回读取是否成功，文件被截断、格式不符或版本不是当前版本时返回false
+bool loadReplay(const QString& path, Replay& replay, QString* error = nullptr);
+
+// 计算棋盘哈希
+// cells: 压缩棋盘
+// 返回64位FNV-1a哈希，用于比较重放结果
+quint64 boardHash(const QByteArray& cells);
+
+// 对局录制器
+// 游戏窗口在输入和定时器入口处调用，按时间顺序记录事件；只有对局结束时写入重放文件，中途退出的对局直接丢弃
+class ReplayRecorder
+{
+public:
+    // 开始录制
+    // mode: 游戏模式
+    // seed: 对局随机种子
+    void start(GameMode mode, quint32 seed);
+
+    // 是否正在录制
+    bool isRecording() const { return recording; }
+
+    // 放弃录制
+    // 对局状态被外部改变（如读取存档）后重放无法还原，直接丢弃
+    void cancel() { recording = false; }
+
+    // 记录按键
+    // key: Qt::Key
+    void recordKey(int key);
+
+    // 记录点击
+    // cell: 点击的地图坐标
+    void recordClick(const QPoint& cell);
+
+    // 记录定时器触发
+    // tick: 定时器
+    void recordTick(ReplayTick tick);
+
+    // 记录关键帧
+    // keyframe: 游戏窗口保存的状态，事件下标和时间由录制器填写
+    void recordKeyframe(ReplayKeyframe keyframe);
+
+    // 获取录制中的重放数据
+    const Replay& recorded() const { return replay; }
+
+    // 结束录制并写入重放文件
+    // score1, score2: 最终分数
+    // cells: 最终压缩棋盘
+    // 文件写入应用数据目录下的replays子目录
+    void finish(int score1, int score2, const QByteArray& cells);
+
+private:
+    // 追加一条事件
+    void record(ReplayEventType type, qint32 value);
+
+    bool recording = false;  // 是否正在录制
+    Replay replay;           // 录制中的重放数据
+    QElapsedTimer clock;     // 对局计时
+};
+
+// 重放结果
+struct ReplayResult {
+    bool matched = false;    // 最终分数和棋盘哈希是否与录制时一致
+    int score1 = 0, score2 = 0; // 重放得到的分数
+    quint64 boardHash = 0;   // 重放得到的棋盘哈希
+    qint64 elapsedMs = 0;    // 重放耗时（毫秒）
+};
+
+// 无窗口重放器
+// 用录制的种子创建不启动定时器的游戏窗口，按顺序直接调用事件处理函数，全速推进对局
+// 跳转时恢复最近的关键帧，只模拟关键帧之后的事件，长录像也能流畅拖动
+class Replayer
+{
+public:
+    // 声明测试类为友元类
+    friend class SimpleTest;
+    // 构造函数
+    // replay: 重放数据，游戏窗口停在开局状态
+    explicit Replayer(const Replay& replay);
+
+    // 析构函数
+    ~Replayer();
+
+    // 获取游戏窗口，用于在查看器中显示
+    QWidget* view() const;
+
+    // 当前位置（距开局的毫秒数）
+    quint32 position() const { return current; }
+
+    // 录像总时长（毫秒）
+    quint32 duration() const { return data.events.isEmpty() ? 0 : data.events.last().time; }
+
+    // 跳转到指定时间
+    // time: 距开局的毫秒数
+    // 向后跳且中间没有更近的关键帧时从当前位置继续模拟，否则从最近的关键帧开始
+    void seek(quint32 time);
+
+    // 重放一局对局
+    // replay: 重放数据
+    // 从开局逐条模拟全部事件，不使用关键帧，返回重放结果
+    static ReplayResult run(const Replay& replay);
+
+private:
+    // 执行一条事件
+    void apply(const ReplayEvent& event);
+
+    Replay data;                     // 重放数据
+    SimpleMode* simple = nullptr;    // 单机模式游戏窗口
+    DuoMode* duo = nullptr;          // 双人模式游戏窗口
+    ReplayKeyframe opening;          // 开局状态
+    int nextEvent = 0;               // 下一条要执行的事件下标
+    quint32 current = 0;             // 当前位置（毫秒）
+};
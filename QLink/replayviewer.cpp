@@ -0,0 +1,76 @@
+#include "replayviewer.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+// 构造函数
+// replay: 重放数据
+// parent: 父窗口指针
+ReplayViewer::ReplayViewer(const Replay& replay, QWidget* parent)
+    : QWidget(parent)
+    , replayer(replay)
+{
+    setWindowTitle("录像回放");
+    resize(1200, 860);
+    // 游戏窗口嵌入查看器，只显示不接收输入
+    QWidget* view = replayer.view();
+    view->setParent(this, Qt::Widget);
+    view->setEnabled(false);
+    playButton = new QPushButton("播放", this);
+    slider = new QSlider(Qt::Horizontal, this);
+    slider->setRange(0, int(replayer.duration()));
+    slider->setSingleStep(1000);
+    slider->setPageStep(10000);
+    timeLabel = new QLabel(this);
+    QHBoxLayout* controls = new QHBoxLayout();
+    controls->addWidget(playButton);
+    controls->addWidget(slider, 1);
+    controls->addWidget(timeLabel);
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(view, 1);
+    layout->addLayout(controls);
+    playTimer = new QTimer(this);
+    connect(playTimer, &QTimer::timeout, this, &ReplayViewer::advance);
+    connect(playButton, &QPushButton::clicked, this, &ReplayViewer::togglePlay);
+    connect(slider, &QSlider::valueChanged, this, &ReplayViewer::seekTo);
+    updateTimeLabel();
+}
+
+// 播放或暂停
+void ReplayViewer::togglePlay()
+{
+    if (playTimer->isActive()) {
+        playTimer->stop();
+        playButton->setText("播放");
+        return;
+    }
+    if (replayer.position() >= replayer.duration()) slider->setValue(0);
+    playClock.start();
+    playTimer->start(16);
+    playButton->setText("暂停");
+}
+
+// 播放时按真实时间推进
+void ReplayViewer::advance()
+{
+    quint32 next = replayer.position() + quint32(playClock.restart());
+    if (next >= replayer.duration()) {
+        next = replayer.duration();
+        togglePlay();
+    }
+    slider->setValue(int(next)); // 触发seekTo
+}
+
+// 进度条拖动时跳转
+// value: 目标时间（毫秒）
+void ReplayViewer::seekTo(int value)
+{
+    replayer.seek(quint32(value));
+    updateTimeLabel();
+}
+
+// 刷新时间显示
+void ReplayViewer::updateTimeLabel()
+{
+    auto format = [](quint32 ms) { return QString("%1:%2").arg(ms / 60000).arg(ms / 1000 % 60, 2, 10, QChar('0')); };
+    timeLabel->setText(format(replayer.position()) + " / " + format(replayer.duration()));
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QWidget>
+#include <QSlider>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "replay.h"
+
+// 重放查看窗口
+// 显示重放中的游戏画面，可播放、暂停，拖动进度条跳转到任意时间
+// 跳转由重放器从最近的关键帧开始模拟，长录像拖动时也不必从开局重算
+class ReplayViewer : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // 构造函数
+    // replay: 重放数据
+    // parent: 父窗口指针
+    explicit ReplayViewer(const Replay& replay, QWidget* parent = nullptr);
+
+private slots:
+    // 播放或暂停
+    void togglePlay();
+
+    // 播放时按真实时间推进
+    void advance();
+
+    // 进度条拖动时跳转
+    // value: 目标时间（毫秒）
+    void seekTo(int value);
+
+private:
+    // 刷新时间显示
+    void updateTimeLabel();
+
+    Replayer replayer;          // 重放器，持有游戏窗口
+    QSlider* slider;            // 进度条，单位毫秒
+    QLabel* timeLabel;          // 当前时间/总时长
+    QPushButton* playButton;    // 播放/暂停按钮
+    QTimer* playTimer;          // 播放定时器
+    QElapsedTimer playClock;    // 距上次推进的真实时间
+};
@@ -0,0 +1,135 @@
+#include "savebrowser.h"
+#include <QDateTime>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QPixmap>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+// 构造函数
+// parent: 父窗口指针
+// mode: 只列出该模式的存档
+SaveBrowser::SaveBrowser(QWidget* parent, const GameMode* mode)
+    : QDialog(parent)
+{
+    if (mode) {
+        filtered = true;
+        this->mode = *mode;
+    }
+    setWindowTitle("读取存档");
+    resize(480, 560);
+    list = new QListWidget(this);
+    list->setIconSize(QSize(48, 48));
+    list->setUniformItemSizes(true); // 所有行等高，上千条存档也无需逐行测量
+    QPushButton* loadButton = new QPushButton("读取", this);
+    QPushButton* browseButton = new QPushButton("浏览文件...", this);
+    QPushButton* cancelButton = new QPushButton("取消", this);
+    QHBoxLayout* buttons = new QHBoxLayout();
+    buttons->addWidget(browseButton);
+    buttons->addStretch();
+    buttons->addWidget(loadButton);
+    buttons->addWidget(cancelButton);
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(list);
+    layout->addLayout(buttons);
+    connect(list, &QListWidget::itemDoubleClicked, this, &SaveBrowser::acceptCurrent);
+    connect(loadButton, &QPushButton::clicked, this, &SaveBrowser::acceptCurrent);
+    connect(browseButton, &QPushButton::clicked, this, &SaveBrowser::browseFiles);
+    connect(cancelButton, &QPushButton::clicked, this, &SaveBrowser::reject);
+    connect(SaveLibrary::instance(), &SaveLibrary::changed, this, &SaveBrowser::populate);
+    connect(SaveLibrary::instance(), &SaveLibrary::entrySaved, this, &SaveBrowser::updateEntry);
+    populate();
+}
+
+// 获取选中的存档路径
+QString SaveBrowser::selectedPath() const
+{
+    return path;
+}
+
+// 按存档库当前内容同步列表
+// 列表项按存档库的顺序逐行对齐：位置不对的移过来，已不存在的删除
+void SaveBrowser::populate()
+{
+    QString current = list->currentItem() ? list->currentItem()->data(Qt::UserRole).toString() : QString();
+    int row = 0;
+    for (const SaveEntry& entry : SaveLibrary::instance()->entries()) {
+        if (!accepts(entry)) continue;
+        QListWidgetItem* item = list->item(row);
+        if (!item || item->data(Qt::UserRole).toString() != entry.fileName) {
+            item = takeItem(entry.fileName);
+            if (!item) item = new QListWidgetItem();
+            list->insertItem(row, item);
+        }
+        // 大小和修改时间都没变的存档，文字和缩略图不必重新生成
+        if (item->data(Qt::UserRole + 1).toLongLong() != entry.modified || item->data(Qt::UserRole + 2).toLongLong() != entry.size)
+            describe(item, entry);
+        ++row;
+    }
+    while (list->count() > row) delete list->takeItem(row);
+    for (int i = 0; i < list->count(); ++i)
+        if (list->item(i)->data(Qt::UserRole).toString() == current) list->setCurrentRow(i);
+    if (!list->currentItem() && list->count() > 0) list->setCurrentRow(0);
+}
+
+// 更新刚保存的一个存档
+// 新保存的存档排在存档库最前面，列表中只移动或新建这一项
+void SaveBrowser::updateEntry(const QString& fileName)
+{
+    int row = 0;
+    for (const SaveEntry& entry : SaveLibrary::instance()->entries()) {
+        if (entry.fileName == fileName) {
+            if (!accepts(entry)) return;
+            QListWidgetItem* item = takeItem(fileName);
+            if (!item) item = new QListWidgetItem();
+            describe(item, entry);
+            list->insertItem(row, item);
+            list->setCurrentItem(item);
+            return;
+        }
+        if (accepts(entry)) ++row;
+    }
+}
+
+// 按存档信息设置列表项
+void SaveBrowser::describe(QListWidgetItem* item, const SaveEntry& entry) const
+{
+    QString text = entry.mode == GameMode::Single
+        ? QString("单人  分数 %1").arg(entry.score1)
+        : QString("双人  %1 : %2").arg(entry.score1).arg(entry.score2);
+    text += QString("  剩余 %1s\n%2  %3")
+                .arg(entry.timeLeft)
+                .arg(QDateTime::fromMSecsSinceEpoch(entry.modified).toString("yyyy-MM-dd HH:mm:ss"))
+                .arg(entry.fileName);
+    QPixmap thumbnail = QPixmap::fromImage(entry.thumbnailImage().scaled(list->iconSize(), Qt::KeepAspectRatio, Qt::FastTransformation));
+    item->setIcon(QIcon(thumbnail));
+    item->setText(text);
+    item->setData(Qt::UserRole, entry.fileName);
+    item->setData(Qt::UserRole + 1, entry.modified);
+    item->setData(Qt::UserRole + 2, entry.size);
+}
+
+// 取出文件名对应的列表项
+QListWidgetItem* SaveBrowser::takeItem(const QString& fileName)
+{
+    for (int i = 0; i < list->count(); ++i)
+        if (list->item(i)->data(Qt::UserRole).toString() == fileName) return list->takeItem(i);
+    return nullptr;
+}
+
+// 确认选择列表中的存档
+void SaveBrowser::acceptCurrent()
+{
+    if (!list->currentItem()) return;
+    path = SaveLibrary::directory() + "/" + list->currentItem()->data(Qt::UserRole).toString();
+    accept();
+}
+
+// 通过文件对话框选择存档库以外的存档
+void SaveBrowser::browseFiles()
+{
+    QString file = QFileDialog::getOpenFileName(this, "读取存档", SaveLibrary::directory(), "存档文件 (*.qsav *.txt)");
+    if (file.isEmpty()) return;
+    path = file;
+    accept();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <QDialog>
+#include <QListWidget>
+#include "load.h"
+#include "savelibrary.h"
+
+// 存档浏览对话框
+// 从存档库的索引列出存档的模式、分数、剩余时间、保存时间和缩略图，不打开任何存档文件
+// 存档库后台扫描完成后自动刷新列表；存档库以外的文件可通过"浏览文件"选择
+class SaveBrowser : public QDialog
+{
+    Q_OBJECT
+    friend class SimpleTest;
+
+public:
+    // 构造函数
+    // parent: 父窗口指针
+    // mode: 只列出该模式的存档，为nullptr时列出全部存档
+    explicit SaveBrowser(QWidget* parent = nullptr, const GameMode* mode = nullptr);
+
+    // 获取选中的存档路径
+    // 返回用户选择的存档文件路径，未选择时为空
+    QString selectedPath() const;
+
+private slots:
+    // 按存档库当前内容同步列表
+    // 复用文件名相同的列表项，只为新增或被修改的存档重新生成文字和缩略图
+    void populate();
+
+    // 更新刚保存的一个存档
+    // fileName: 存档文件名
+    void updateEntry(const QString& fileName);
+
+    // 确认选择列表中的存档
+    void acceptCurrent();
+
+    // 通过文件对话框选择存档库以外的存档
+    void browseFiles();
+
+private:
+    // 存档是否在列表中显示
+    bool accepts(const SaveEntry& entry) const { return !filtered || entry.mode == mode; }
+
+    // 按存档信息设置列表项的文字、缩略图和文件名
+    void describe(QListWidgetItem* item, const SaveEntry& entry) const;
+
+    // 取出文件名对应的列表项，没有时返回nullptr
+    QListWidgetItem* takeItem(const QString& fileName);
+
+    QListWidget* list;          // 存档列表
+    bool filtered = false;      // 是否按模式筛选
+    GameMode mode = GameMode::Single; // 筛选的游戏模式
+    QString path;               // 选中的存档路径
+};
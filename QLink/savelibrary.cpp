@@ -0,0 +1,220 @@
+#include "savelibrary.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+static const quint32 indexMagic = 0x51494458u; // 索引文件魔数"QIDX"
+static const quint16 indexVersion = 1;        // 索引文件版本号
+static const int thumbMaxSide = 48;           // 缩略图最大边长（像素）
+
+// 获取索引文件路径
+static QString indexPath() {
+    return SaveLibrary::directory() + "/index.qidx";
+}
+
+// 按保存时间从新到旧排序
+static void sortEntries(QVector<SaveEntry>& entries) {
+    std::sort(entries.begin(), entries.end(), [](const SaveEntry& a, const SaveEntry& b) { return a.modified > b.modified; });
+}
+
+// 生成缩略图图像
+QImage SaveEntry::thumbnailImage() const
+{
+    static const QRgb colors[4] = {qRgb(40, 40, 40), qRgb(147, 218, 100), qRgb(102, 178, 255), qRgb(255, 170, 90)};
+    QImage image(thumbWidth, thumbHeight, QImage::Format_RGB32);
+    for (int y = 0; y < thumbHeight; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < thumbWidth; ++x)
+            line[x] = colors[uchar(thumbnail[y * thumbWidth + x]) & 3];
+    }
+    return image;
+}
+
+// 获取全局存档库
+SaveLibrary* SaveLibrary::instance()
+{
+    static SaveLibrary* library = new SaveLibrary(QCoreApplication::instance());
+    return library;
+}
+
+// 获取存档目录
+QString SaveLibrary::directory()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/saves";
+    QDir().mkpath(dir);
+    return dir;
+}
+
+// 构造函数
+// parent: 父对象
+SaveLibrary::SaveLibrary(QObject* parent)
+    : QObject(parent)
+    , list(readIndex())
+{
+    worker.setMaxThreadCount(1);
+    refresh();
+}
+
+// 析构函数
+SaveLibrary::~SaveLibrary()
+{
+    worker.waitForDone();
+}
+
+// 获取存档列表
+const QVector<SaveEntry>& SaveLibrary::entries() const
+{
+    return list;
+}
+
+// 保存游戏并更新索引
+// path: 存档文件路径
+// data: 要保存的游戏数据
+bool SaveLibrary::save(const QString& path, const SaveData& data)
+{
+    if (!saveGame(path, data)) return false;
+    QFileInfo info(path);
+    if (info.absolutePath() != QFileInfo(directory()).absoluteFilePath()) return true;
+    SaveEntry entry = describe(info, data);
+    auto it = std::find_if(list.begin(), list.end(), [&entry](const SaveEntry& e) { return e.fileName == entry.fileName; });
+    if (it != list.end()) list.erase(it);
+    list.prepend(entry);
+    ++generation;
+    writeIndexLater();
+    emit entrySaved(entry.fileName);
+    return true;
+}
+
+// 在后台重新扫描存档目录
+void SaveLibrary::refresh()
+{
+    QVector<SaveEntry> known = list;
+    int started = generation;
+    worker.start([this, known, started]() {
+        QVector<SaveEntry> fresh = scan(known);
+        QMetaObject::invokeMethod(this, [this, fresh, started]() {
+            if (started != generation) {
+                refresh(); // 扫描期间有新存档，结果可能缺少它
+                return;
+            }
+            list = fresh;
+            writeIndexLater();
+            emit changed();
+        }, Qt::QueuedConnection);
+    });
+}
+
+// 在后台线程写入当前列表的索引文件
+void SaveLibrary::writeIndexLater()
+{
+    QVector<SaveEntry> snapshot = list;
+    worker.start([snapshot]() { writeIndex(snapshot); });
+}
+
+// 生成一条存档信息
+// info: 存档文件信息
+// data: 存档数据
+SaveEntry SaveLibrary::describe(const QFileInfo& info, const SaveData& data)
+{
+    SaveEntry entry;
+    entry.fileName = info.fileName();
+    entry.size = info.size();
+    entry.modified = info.lastModified().toMSecsSinceEpoch();
+    entry.mode = data.mode;
+    entry.score1 = data.score1;
+    entry.score2 = data.score2;
+    entry.timeLeft = data.timeLeft;
+    // 按最近邻采样把棋盘缩小到缩略图尺寸，已消除的格子记为空
+    int side = std::max(data.rows, data.cols);
+    entry.thumbWidth = side > thumbMaxSide ? data.cols * thumbMaxSide / side : data.cols;
+    entry.thumbHeight = side > thumbMaxSide ? data.rows * thumbMaxSide / side : data.rows;
+    entry.thumbWidth = std::max(entry.thumbWidth, 1);
+    entry.thumbHeight = std::max(entry.thumbHeight, 1);
+    entry.thumbnail = QByteArray(entry.thumbWidth * entry.thumbHeight, 0);
+    for (int y = 0; y < entry.thumbHeight; ++y)
+        for (int x = 0; x < entry.thumbWidth; ++x) {
+            int row = y * data.rows / entry.thumbHeight;
+            int col = x * data.cols / entry.thumbWidth;
+            if (data.stateAt(row, col) != 0)
+                entry.thumbnail[y * entry.thumbWidth + x] = char(data.formAt(row, col) + 1);
+        }
+    return entry;
+}
+
+// 扫描存档目录
+// known: 已知的存档信息
+QVector<SaveEntry> SaveLibrary::scan(const QVector<SaveEntry>& known)
+{
+    QHash<QString, int> byName;
+    for (int i = 0; i < known.size(); ++i) byName.insert(known[i].fileName, i);
+    QVector<SaveEntry> entries;
+    const QList<QFileInfo> files = QDir(directory()).entryInfoList({"*.qsav", "*.txt"}, QDir::Files);
+    for (const QFileInfo& info : files) {
+        auto it = byName.constFind(info.fileName());
+        if (it != byName.constEnd()) {
+            const SaveEntry& entry = known[it.value()];
+            if (entry.size == info.size() && entry.modified == info.lastModified().toMSecsSinceEpoch()) {
+                entries.append(entry);
+                continue;
+            }
+        }
+        SaveData data;
+        if (loadGame(info.absoluteFilePath(), data)) entries.append(describe(info, data));
+    }
+    sortEntries(entries);
+    return entries;
+}
+
+// 读取索引文件
+QVector<SaveEntry> SaveLibrary::readIndex()
+{
+    QVector<SaveEntry> entries;
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) return entries;
+    QDataStream in(&file);
+    quint32 magic, count;
+    quint16 version;
+    in >> magic >> version >> count;
+    if (magic != indexMagic || version != indexVersion) return entries;
+    entries.reserve(std::min<quint32>(count, 1 << 16));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        SaveEntry entry;
+        quint8 mode;
+        qint32 score1, score2, timeLeft;
+        quint16 thumbWidth, thumbHeight;
+        in >> entry.fileName >> entry.size >> entry.modified >> mode >> score1 >> score2 >> timeLeft
+           >> thumbWidth >> thumbHeight >> entry.thumbnail;
+        entry.mode = mode == 0 ? GameMode::Single : GameMode::Duo;
+        entry.score1 = score1;
+        entry.score2 = score2;
+        entry.timeLeft = timeLeft;
+        entry.thumbWidth = thumbWidth;
+        entry.thumbHeight = thumbHeight;
+        if (entry.thumbnail.size() != thumbWidth * thumbHeight) break;
+        entries.append(entry);
+    }
+    if (in.status() != QDataStream::Ok) entries.clear(); // 索引损坏，等待后台扫描重建
+    sortEntries(entries);
+    return entries;
+}
+
+// 写入索引文件
+// entries: 存档信息列表
+void SaveLibrary::writeIndex(const QVector<SaveEntry>& entries)
+{
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)) return;
+    QDataStream out(&file);
+    out << indexMagic << indexVersion << quint32(entries.size());
+    for (const SaveEntry& entry : entries)
+        out << entry.fileName << entry.size << entry.modified << quint8(entry.mode == GameMode::Single ? 0 : 1)
+            << qint32(entry.score1) << qint32(entry.score2) << qint32(entry.timeLeft)
+            << quint16(entry.thumbWidth) << quint16(entry.thumbHeight) << entry.thumbnail;
+    file.commit();
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QImage>
+#include <QThreadPool>
+#include "load.h"
+
+class QFileInfo;
+
+// 存档库中的一条存档信息
+// 由索引文件提供，列出存档时无需打开存档文件
+struct SaveEntry {
+    QString fileName;             // 存档文件名（相对存档目录）
+    qint64 size = 0;              // 文件大小（字节），与修改时间一起判断索引是否过期
+    qint64 modified = 0;          // 文件修改时间（毫秒），即保存时间
+    GameMode mode = GameMode::Single; // 游戏模式
+    int score1 = 0, score2 = 0;   // 玩家1和玩家2的分数
+    int timeLeft = 0;             // 剩余时间（秒）
+    int thumbWidth = 0;           // 缩略图宽度
+    int thumbHeight = 0;          // 缩略图高度
+    QByteArray thumbnail;         // 缩略图，每像素一个字节：0为空格子，1-3为方块形状
+
+    // 生成缩略图图像
+    // 返回按方块形状着色的缩略图
+    QImage thumbnailImage() const;
+};
+
+// 存档库
+// 存档统一放在应用数据目录的saves子目录下，目录中的index.qidx记录每个存档的摘要
+// 启动时只读取索引文件，后台线程再扫描目录补全新增或被修改的存档，更新后发出changed信号
+// 保存存档时立即更新内存中的列表，索引文件在后台线程写入
+class SaveLibrary : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 获取全局存档库
+    // 首次调用时读取索引并开始后台扫描
+    static SaveLibrary* instance();
+
+    // 析构函数
+    // 等待后台扫描和索引写入完成
+    ~SaveLibrary();
+
+    // 获取存档目录
+    // 返回存档目录路径，目录不存在时创建
+    static QString directory();
+
+    // 获取存档列表
+    // 返回按保存时间从新到旧排列的存档信息
+    const QVector<SaveEntry>& entries() const;
+
+    // 保存游戏并更新索引
+    // path: 存档文件路径
+    // data: 要保存的游戏数据
+    // 返回保存是否成功；存档位于存档目录下时同时加入存档列表
+    bool save(const QString& path, const SaveData& data);
+
+    // 在后台重新扫描存档目录
+    // 索引中大小和修改时间都未变的存档直接复用，其余存档重新读取
+    void refresh();
+
+signals:
+    // 存档列表已更新（后台扫描完成）
+    void changed();
+
+    // 一个存档已保存并移到列表最前面
+    // fileName: 存档文件名（相对存档目录）
+    void entrySaved(const QString& fileName);
+
+private:
+    // 构造函数
+    // parent: 父对象
+    explicit SaveLibrary(QObject* parent);
+
+    // 在后台线程写入当前列表的索引文件
+    void writeIndexLater();
+
+    // 生成一条存档信息
+    // info: 存档文件信息
+    // data: 存档数据
+    static SaveEntry describe(const QFileInfo& info, const SaveData& data);
+
+    // 扫描存档目录
+    // known: 已知的存档信息
+    // 返回目录中全部存档的信息
+    static QVector<SaveEntry> scan(const QVector<SaveEntry>& known);
+
+    // 读取索引文件，文件不存在或损坏时返回空列表
+    static QVector<SaveEntry> readIndex();
+
+    // 写入索引文件
+    // entries: 存档信息列表
+    static void writeIndex(const QVector<SaveEntry>& entries);
+
+    QVector<SaveEntry> list;      // 存档列表
+    QThreadPool worker;           // 单线程后台工作池，保证索引按顺序写入
+    int generation = 0;           // 列表版本号，扫描期间有新存档时丢弃扫描结果并重新扫描
+};
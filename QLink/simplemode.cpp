@@ -4,34 +4,49 @@
 #include <QDir>
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QResizeEvent>
 #include <QPainter>
 #include <QMessageBox>
 #include <QRandomGenerator>
 #include <queue>
 #include <algorithm>
+#include <cmath>
 #include <QDebug>
 #include <QPainterPath>
 #include <QLabel>
 #include "item.h"
-#include <QTimer>
+#include "packedboard.h"
 #include "load.h"
 #include "pausemenu.h"
 #include <QFileDialog>
+#include <QDateTime>
+#include "savelibrary.h"
+#include "savebrowser.h"
+#include <QtGlobal>
 
 // 构造函数
 // parent: 父窗口指针，默认为nullptr
 // saveData: 存档数据指针，用于加载游戏状态，默认为nullptr
-SimpleMode::SimpleMode(QWidget *parent, const SaveData* saveData)
+// seed: 对局随机种子
+// headless: 是否为无窗口重放
+// board: 后台预先发好的开局棋盘，可以为空
+SimpleMode::SimpleMode(QWidget *parent, const SaveData* saveData, quint32 seed, bool headless, const PreparedBoard* board)
     : QMainWindow(parent)
     , ui(new Ui::SimpleModeClass())
+    , seed(seed)
+    , rng(seed)
+    , headless(headless)
 {
     blockWidth = 50;
     blockHeight = 50;
     ui->setupUi(this);
+    animations = new AnimationDriver(this);
     
     this->setWindowModality(Qt::WindowModal);
-    this->setFixedSize(1200, 800);
-    this->setStyleSheet("SimpleMode { background-image: url(:/images/images/background2.png); }");
+    this->resize(1200, 800); // 窗口可自由缩放，格子尺寸在resizeEvent中重新计算
+    // 背景图只解码一次，按窗口尺寸缩放后缓存，绘制时整窗覆盖，无需先擦除背景
+    backgroundSource = QPixmap(":/images/images/background2.png");
+    setAttribute(Qt::WA_OpaquePaintEvent);
     setWindowFlags(windowFlags() & ~Qt::WindowCloseButtonHint); // 禁用右上角关闭
 
     ui->exitBtn->setStyleSheet("color: rgb(147, 218, 100);");
@@ -50,28 +65,19 @@ SimpleMode::SimpleMode(QWidget *parent, const SaveData* saveData)
     progressBar->setFormat(timeStr);
     progressBar->setStyleSheet("QProgressBar{height:22px; text-align:center; font-size:14px; color:white; border-radius:4px; background:rgb(147, 218, 100);}"
                                "QProgressBar::chunk{border-radius:4px;background:qlineargradient(spread:pad,x1:0,y1:0,x2:1,y2:0,stop:0 rgb(147, 218, 100),stop:1 rgb(205,218,224));}");
-    progressTimer = new QTimer(this);
-    connect(progressTimer, &QTimer::timeout, this, &SimpleMode::progress);
-    progressTimer->start(1000);
-    // 道具定时器
-    propTimer = new QTimer(this);
-    connect(propTimer, &QTimer::timeout, this, &SimpleMode::generateProp);
-    propTimer->start(30000); // 30秒
-    // Hint/Flash定时器初始化
-    hintTimer = new QTimer(this);
-    flashTimer = new QTimer(this);
-    connect(hintTimer, &QTimer::timeout, this, [this]() {
-        hintActive = false;
-        hintBlock1 = QPoint(-1, -1);
-        hintBlock2 = QPoint(-1, -1);
-        hintTimer->stop();
-        update();
-    });
-    connect(flashTimer, &QTimer::timeout, this, [this]() {
-        flashActive = false;
-        flashTimer->stop();
-        update();
-    });
+    // 倒计时、道具生成、自动存档和道具效果都由同一个调度器按游戏时间触发
+    // 无窗口时使用手动时钟，由调用方快进
+    scheduler = new GameScheduler(this, headless);
+    connect(scheduler, &GameScheduler::fired, this, &SimpleMode::onTimer);
+    // 状态变化的订阅者：先写日志，再刷新显示和判定
+    connect(this, &SimpleMode::gameEvent, this, [this](const GameEvent& event) { journal.record(event); });
+    connect(this, &SimpleMode::gameEvent, this, &SimpleMode::onGameEvent);
+    connect(&hintSolver, &HintSolver::solved, this, &SimpleMode::onHintSolved);
+    if (!headless) {
+        scheduler->schedule(GameTimer::Progress, 1000, 1000);
+        scheduler->schedule(GameTimer::Prop, 30000, 30000);      // 30秒
+        scheduler->schedule(GameTimer::Autosave, 60000, 60000);  // 60秒
+    }
     // blocks初始化为rows*cols，边界为state=0，游戏区后面填充
     blocks.resize(rows);
     for (int i = 0; i < rows; ++i) {
@@ -86,26 +92,22 @@ SimpleMode::SimpleMode(QWidget *parent, const SaveData* saveData)
         }
     }
     // 生成有效方块区
-    QVector<Block*> gameBlocks;
-    for (int i = 2; i < rows-2; ++i) {
-        for (int j = 2; j < cols-2; j += 2) {
-            int randomForm = QRandomGenerator::global()->bounded(formNum);
-            Block* b1 = new Block(topX + j * blockWidth, topY + i * blockHeight, blockWidth, blockHeight, randomForm, 1);
-            Block* b2 = new Block(topX + (j + 1) * blockWidth, topY + i * blockHeight, blockWidth, blockHeight, randomForm, 1);
-            b1->setMapXY(j, i);
-            b2->setMapXY(j + 1, i);
-            gameBlocks.append(b1);
-            gameBlocks.append(b2);
-        }
-    }
-    int idx = 0;
+    // 有后台预先发好的同种子棋盘时直接使用，否则当场发牌，两者得到的棋盘和随机数状态相同
+    if (board && !board->matches(seed, rows, cols, formNum))
+        qWarning() << "预先发好的棋盘与本局不符，当场发牌";
+    const PreparedBoard dealt = board && board->matches(seed, rows, cols, formNum) ? *board : dealBoard(seed, rows, cols, formNum);
+    rng = dealt.rng;
     for (int i = 2; i < rows-2; ++i) {
         for (int j = 2; j < cols-2; ++j) {
-            blocks[i][j] = gameBlocks[idx++];
+            const int form = packedForm(uchar(dealt.cells[i * cols + j]));
+            blocks[i][j] = new Block(topX + j * blockWidth, topY + i * blockHeight, blockWidth, blockHeight, form, 1);
+            blocks[i][j]->setMapXY(j, i);
         }
     }
-    shuffle();
+    syncPackedCells();
     initTextures();
+    // 超大棋盘或设置了QLINK_TILED_RENDER环境变量时，改用分块并行渲染
+    tiledRender = rows * cols >= 64 * 64 || qEnvironmentVariableIsSet("QLINK_TILED_RENDER");
     this->setFocusPolicy(Qt::StrongFocus);
     player = new Player(topX, topY, 0);
     // 设置玩家初始地图坐标（地图左上角）
@@ -119,23 +121,35 @@ SimpleMode::SimpleMode(QWidget *parent, const SaveData* saveData)
     updateScoreLabel();
 
     // 游戏开始时立即生成一个道具
+    props.reset(rows, cols);
+    rebuildFreeCells();
     generateProp();
     
     // 如果有存档数据，应用存档
     if (saveData) applySaveData(*saveData);
+    // 开局状态作为第一个关键帧，之后的随机事件都从关键帧的种子开始
+    markKeyframe();
+    history.reset(undoStep());
+    // 日志从这份快照开始记录
+    autosave(true);
+    // 设置了QLINK_RECORD_REPLAY环境变量时录制新开的对局，读档的对局无法从种子复现
+    if (!saveData && !headless && qEnvironmentVariableIsSet("QLINK_RECORD_REPLAY"))
+        recorder.start(GameMode::Single, seed);
+    // 开局棋盘交给后台查找：预先算好Hint方块对，发到死局时按策略处理
+    updateHint();
 }
 
 // 析构函数
 SimpleMode::~SimpleMode()
 {
-    for (Item* prop : props) delete prop;
+    if (qEnvironmentVariableIsSet("QLINK_LATENCY_REPORT")) qInfo().noquote() << latency.report();
     delete ui;
 }
 
 // 更新分数
 void SimpleMode::updateScore(int delta) {
     score += delta;
-    updateScoreLabel();
+    emit gameEvent(GameEvent::scoreChanged(1, score));
 }
 
 // 更新分数显示
@@ -143,28 +157,19 @@ void SimpleMode::updateScoreLabel() {
     scoreLabel->setText(QString("分数: %1").arg(score));
 }
 
-// 检查游戏是否结束
-void SimpleMode::checkGameOver() {
-    for (int i = 2; i < rows-2; ++i) {
-        for (int j = 2; j < cols-2; ++j) {
-            Block* b1 = blocks[i][j];
-            if (!b1 || b1->getState() == 0) continue;
-            for (int ii = 2; ii < rows-2; ++ii) {
-                for (int jj = 2; jj < cols-2; ++jj) {
-                    if (i == ii && j == jj) continue;
-                    Block* b2 = blocks[ii][jj];
-                    if (!b2 || b2->getState() == 0) continue;
-                    if (b1->getForm() == b2->getForm() && canLink(b1->getMapX(), b1->getMapY(), b2->getMapX(), b2->getMapY())) {
-                        return; // 还有可消除对
-                    }
-                }
-            }
-        }
-    }
-    // 没有可消除对，游戏结束
-    progressTimer->stop(); // 停止计时器，防止时间到时再次弹出弹窗
-    QMessageBox::information(this, "游戏结束", QString("游戏结束！最终分数：%1").arg(score));
-    close();
+// 结束对局
+// message: 结束弹窗显示的文字
+void SimpleMode::finishGame(const QString& message) {
+    scheduler->clear(); // 停止所有定时事件，结束弹窗不阻塞，关闭前不能再生成道具或自动存档
+    finished = true;
+    recorder.finish(score, 0, packedBoard());
+    if (headless) return;
+    autosaver.discard();
+    // 弹窗不阻塞事件循环，关闭弹窗后再关闭窗口
+    QMessageBox* box = new QMessageBox(QMessageBox::Information, "游戏结束", message, QMessageBox::Ok, this);
+    box->setAttribute(Qt::WA_DeleteOnClose);
+    connect(box, &QMessageBox::finished, this, &QWidget::close);
+    box->open();
 }
 
 // 游戏进度更新
@@ -172,19 +177,15 @@ void SimpleMode::progress()
 {
     if (timeLeft > 0) {
         timeLeft--;
-        progressBar->setValue(timeLeft);
-        QString timeStr = QString::number(timeLeft) + "s";
-        progressBar->setFormat(timeStr);
-    }
-    if (timeLeft == 0) {
-        progressTimer->stop();
-        QMessageBox::information(this, "游戏结束", QString("时间到！最终分数：%1").arg(score));
-        close();
+        emit gameEvent(GameEvent::timeChanged(timeLeft));
+        autosave(false);
     }
+    if (timeLeft == 0) finishGame(QString("时间到！最终分数：%1").arg(score));
+    if (!finished && ++ticks % replayKeyframeInterval == 0) markKeyframe();
 }
 
 // 洗牌功能
-void SimpleMode::shuffle()
+void SimpleMode::shuffle(quint32 seed)
 {
     QVector<Block*> nonEmptyBlocks;
     QVector<QPair<int, int>> positions;
@@ -196,11 +197,11 @@ void SimpleMode::shuffle()
             }
         }
     }
-    std::shuffle(nonEmptyBlocks.begin(), nonEmptyBlocks.end(), *QRandomGenerator::global());
+    QVector<int> order = shufflePermutation(nonEmptyBlocks.size(), seed);
     for (int idx = 0; idx < positions.size(); ++idx) {
         int i = positions[idx].first;
         int j = positions[idx].second;
-        blocks[i][j] = nonEmptyBlocks[idx];
+        blocks[i][j] = nonEmptyBlocks[order[idx]];
         // 同步mapXY和像素坐标，防止消除判定错乱
         blocks[i][j]->setMapXY(j, i);
         blocks[i][j]->setCord(topX + j * blockWidth, topY + i * blockHeight);
@@ -213,111 +214,311 @@ void SimpleMode::initTextures()
 {
     QVector<int> allIds{1,2,3,4,5,6,7};
     std::shuffle(allIds.begin(), allIds.end(), *QRandomGenerator::global());
+    textures.setSpriteSize(blockWidth - 2 * spriteMargin, devicePixelRatioF());
     for (int i = 0; i < 3; ++i) {
         blockTextureIds[i] = allIds[i];
-        QString file = QString(":/images/images/%1-1.png").arg(blockTextureIds[i]);
-        blockPixmaps[i] = QPixmap(file).scaled(46, 46, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        for (int s = 0; s < 2; ++s) {
+            blockTextureFiles[i][s] = QString(":/images/images/%1-%2.png").arg(blockTextureIds[i]).arg(s + 1);
+            textures.pixmap(blockTextureFiles[i][s], Qt::FastTransformation); // 像素风贴图，预先解码并缩放
+        }
     }
     playerTextureFile = ":/images/images/player1.png";
-    playerPixmap = QPixmap(playerTextureFile).scaled(46, 46, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    textures.pixmap(playerTextureFile);
+}
+
+// 按窗口尺寸重新计算布局
+// 以1200x800为基准等比缩放格子尺寸，游戏区水平居中
+// 贴图和背景图在此统一重新缩放一次，绘制时不再缩放
+void SimpleMode::relayout()
+{
+    if (!scoreLabel) return; // 构造尚未完成
+    qreal scale = std::min(width() / 1200.0, height() / 800.0);
+    blockWidth = std::max(8, int(50 * scale));
+    blockHeight = blockWidth;
+    spriteMargin = std::max(1, blockWidth / 25);
+    topX = (width() - cols * blockWidth) / 2;
+    topY = qRound(80 * scale);
+    textures.setSpriteSize(blockWidth - 2 * spriteMargin, devicePixelRatioF());
+    background = scaledBackground(backgroundSource, size(), devicePixelRatioF());
+    if (tiledRender) updateTileSprites();
+
+    // 同步方块、玩家和道具的像素坐标
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (blocks[i][j])
+                blocks[i][j]->getCord() = QRectF(topX + j * blockWidth, topY + i * blockHeight, blockWidth, blockHeight);
+    QRectF& playerRect = player->getCord();
+    playerRect = QRectF(topX + player->getXInMap() * blockWidth, topY + player->getYInMap() * blockHeight, blockWidth, blockHeight);
+    for (Item& prop : props) {
+        QPoint pos = prop.getMapPos();
+        prop.setRect(QRectF(topX + pos.x() * blockWidth, topY + pos.y() * blockHeight, blockWidth, blockHeight));
+        prop.setPixmap(textures.pixmap(itemTextureFile(prop.getType())));
+    }
+
+    // 其余控件随窗口移动
+    progressBar->setGeometry(topX, qRound(20 * scale), cols * blockWidth, std::max(20, qRound(40 * scale)));
+    ui->exitBtn->move(width() - 230, 17);
+    ui->pauseBtn->move(width() - 116, 17);
+    scoreLabel->move(20, height() - 80);
+}
+
+// 窗口尺寸变化事件
+// event: 尺寸变化事件指针
+void SimpleMode::resizeEvent(QResizeEvent* event)
+{
+    QMainWindow::resizeEvent(event);
+    relayout();
+}
+
+// 窗口状态变化事件
+// event: 状态变化事件指针
+// 窗口移到不同像素比的屏幕时重新缩放贴图
+void SimpleMode::changeEvent(QEvent* event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::DevicePixelRatioChange && !qFuzzyCompare(textures.devicePixelRatio(), devicePixelRatioF()))
+        relayout();
+}
+
+// 将缩放好的方块贴图交给分块渲染器
+// 工作线程不能使用QPixmap，这里在GUI线程转换为QImage
+void SimpleMode::updateTileSprites()
+{
+    QVector<QImage> sprites;
+    for (int form = 0; form < 3; ++form)
+        for (int state = 0; state < 2; ++state)
+            sprites.append(textures.pixmap(blockTextureFiles[form][state], Qt::FastTransformation).toImage());
+    tileRenderer.setSprites(blockWidth, spriteMargin, textures.devicePixelRatio(), sprites);
+}
+
+// 将棋盘压缩为每格一个字节
+// 返回按行存储的压缩数据，空位置视为已消除的空格
+QByteArray SimpleMode::packedBoard() const
+{
+    QByteArray cells(rows * cols, 0);
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (blocks[i][j])
+                cells[i * cols + j] = char(packBlock(blocks[i][j]->getForm(), blocks[i][j]->getState()));
+    return cells;
+}
+
+// 重新压缩整个棋盘
+// 开局和整盘变化（读档、撤销、洗牌）之后调用，消除只改写两格
+void SimpleMode::syncPackedCells()
+{
+    packedCells = packedBoard();
 }
 
 // 绘制消除路径
+// 每条路径随淡出动画逐渐变透明
 void SimpleMode::drawLinkPath(QPainter& painter)
 {
-    if (linkPath.size() < 2) return;
-    QPen pen(QColor(160, 160, 160), 3);
-    painter.setPen(pen);
-    QVector<QPoint> pixelPoints;
-    for (const QPoint& pt : linkPath) {
-        int px = topX + pt.x() * blockWidth + blockWidth / 2;
-        int py = topY + pt.y() * blockHeight + blockHeight / 2;
-        pixelPoints.append(QPoint(px, py));
+    for (const Animation& anim : animations->animations()) {
+        if (!anim.active || anim.type != AnimationType::PathFade || anim.pointCount < 2) continue;
+        QColor color(160, 160, 160);
+        color.setAlphaF(float(1.0 - anim.progress));
+        painter.setPen(QPen(color, 3));
+        QPoint pixelPoints[4];
+        for (int k = 0; k < anim.pointCount; ++k) {
+            pixelPoints[k] = QPoint(topX + anim.points[k].x() * blockWidth + blockWidth / 2,
+                                    topY + anim.points[k].y() * blockHeight + blockHeight / 2);
+        }
+        painter.drawPolyline(pixelPoints, anim.pointCount);
+    }
+}
+
+// 绘制方块弹出动画
+// 被消除的方块以激活状态贴图放大并淡出
+void SimpleMode::drawAnimations(QPainter& painter)
+{
+    for (const Animation& anim : animations->animations()) {
+        if (!anim.active || anim.type != AnimationType::BlockPop || anim.form < 0 || anim.form >= 3) continue;
+        const QPixmap& pix = textures.pixmap(blockTextureFiles[anim.form][1]);
+        QSizeF size = pix.deviceIndependentSize();
+        qreal scale = 1.0 + 0.4 * anim.progress;
+        painter.save();
+        painter.setOpacity(1.0 - anim.progress);
+        painter.translate(topX + (anim.points[0].x() + 0.5) * blockWidth, topY + (anim.points[0].y() + 0.5) * blockHeight);
+        painter.scale(scale, scale);
+        painter.drawPixmap(QPointF(-size.width() / 2, -size.height() / 2), pix);
+        painter.restore();
     }
-    painter.drawPolyline(pixelPoints.data(), pixelPoints.size());
 }
 
 // 生成道具
-// 道具生成间隔为30秒，由propTimer控制
+// 道具生成间隔为30秒，由调度器触发
 void SimpleMode::generateProp() {
-    QVector<QPoint> empty;
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j)
-            if (blocks[i][j] && blocks[i][j]->getState() == 0) {
-                bool occupied = false;
-                for (Item* prop : props)
-                    if (prop->isVisible() && prop->getMapPos() == QPoint(j, i)) { occupied = true; break; }
-                if (!occupied) empty.append(QPoint(j, i));
-            }
-    if (empty.isEmpty()) return;
-    QPoint pos = empty[QRandomGenerator::global()->bounded(empty.size())];
+    if (freeCells.isEmpty()) return;
+    QPoint pos = freeCells.draw(rng);
     QRectF rect(topX + pos.x() * blockWidth, topY + pos.y() * blockHeight, blockWidth, blockHeight);
-    ItemType type = static_cast<ItemType>(QRandomGenerator::global()->bounded(0, 4));
-    QPixmap pix;
-    switch (type) {
-        case ItemType::AddTime: pix = QPixmap(":/images/images/Time.png"); break;
-        case ItemType::Shuffle: pix = QPixmap(":/images/images/Shuffle.png"); break;
-        case ItemType::Hint:    pix = QPixmap(":/images/images/Hint.png"); break;
-        case ItemType::Flash:   pix = QPixmap(":/images/images/Flash.png"); break;
+    ItemType type = static_cast<ItemType>(rng.bounded(0, 4));
+    props.add(type, pos, rect, textures.pixmap(itemTextureFile(type)));
+    emit gameEvent(GameEvent::propSpawned(pos, type));
+    if (Animation* spawn = animations->start(AnimationType::PropSpawn, 300)) {
+        spawn->points[0] = pos;
+        spawn->pointCount = 1;
     }
-    Item* prop = new Item(type, pos, rect, pix);
-    props.append(prop);
     qDebug() << "生成道具: 类型=" << static_cast<int>(type) << "位置=" << pos;
     update();
 }
 
+// 重建空闲格集合
+// 开局、读档、撤销和洗牌后扫描整个棋盘，其余时候由状态变化增量维护
+void SimpleMode::rebuildFreeCells() {
+    freeCells.reset(rows, cols);
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (blocks[i][j] && blocks[i][j]->getState() == 0) freeCells.insert(QPoint(j, i));
+    for (const Item& prop : props) freeCells.remove(prop.getMapPos());
+}
+
 // 绘制道具
+// 刚生成的道具随出现动画从小放大到原始尺寸
 void SimpleMode::drawProps(QPainter& painter) {
-    for (Item* prop : props)
-        if (prop->isVisible())
-            prop->draw(painter);
+    for (const Item& prop : props) {
+        qreal scale = 1.0;
+        for (const Animation& anim : animations->animations())
+            if (anim.active && anim.type == AnimationType::PropSpawn && anim.points[0] == prop.getMapPos())
+                scale = 0.3 + 0.7 * anim.progress;
+        if (scale < 1.0) {
+            QPointF center = prop.getRect().center();
+            painter.save();
+            painter.translate(center.x(), center.y());
+            painter.scale(scale, scale);
+            painter.translate(-center.x(), -center.y());
+            prop.draw(painter);
+            painter.restore();
+        } else {
+            prop.draw(painter);
+        }
+    }
 }
 
 // 绘制事件
 void SimpleMode::paintEvent(QPaintEvent* event)
 {
     QPainter painter(this);
+    painter.drawPixmap(0, 0, background);
     painter.setBrush(QColor(147, 218, 100));
     painter.setPen(Qt::NoPen);
-    painter.drawRect(topX, topY, 700, 700);
+    painter.drawRect(topX, topY, cols * blockWidth, rows * blockHeight);
     
-    if (hintActive && hintBlock1 != QPoint(-1, -1) && hintBlock2 != QPoint(-1, -1)) {
+    if (effects.isActive(ItemType::Hint) && hintBlock1 != QPoint(-1, -1) && hintBlock2 != QPoint(-1, -1)) {
+        // Hint高亮随脉动动画明暗变化
+        qreal pulse = 0.5;
+        for (const Animation& anim : animations->animations())
+            if (anim.active && anim.type == AnimationType::HintPulse)
+                pulse = 0.5 - 0.5 * std::cos(anim.progress * 6.283185307);
         painter.setPen(QPen(Qt::red, 3));
-        painter.setBrush(QColor(255, 0, 0, 80));
+        painter.setBrush(QColor(255, 0, 0, 40 + int(80 * pulse)));
         QRectF r1(topX + hintBlock1.x() * blockWidth, topY + hintBlock1.y() * blockHeight, blockWidth, blockHeight);
         QRectF r2(topX + hintBlock2.x() * blockWidth, topY + hintBlock2.y() * blockHeight, blockWidth, blockHeight);
         painter.drawRect(r1);
         painter.drawRect(r2);
     }
     
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            Block* blk = blocks[i][j];
-            if (!blk) continue;
-            int state = blk->getState();
-            if (state == 0) continue;
-            int form = blk->getForm();
-            if (form < 0 || form >= 3) continue;
-            int texNum = blockTextureIds[form];
-            QString file = QString(":/images/images/%1-%2.png").arg(texNum).arg(state);
-            QPixmap pix(file);
-            if (pix.isNull()) pix = blockPixmaps[form];
-            painter.drawPixmap(topX + j * blockWidth + 2, topY + i * blockHeight + 2, 46, 46, pix);
+    if (tiledRender) {
+        // 分块并行渲染：只重绘内容变化的分块，再在GUI线程合成
+        tileRenderer.setBoard(rows, cols, packedBoard());
+        tileRenderer.render();
+        tileRenderer.composite(painter, QPoint(topX, topY));
+    } else {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                Block* blk = blocks[i][j];
+                if (!blk) continue;
+                int state = blk->getState();
+                if (state == 0) continue;
+                int form = blk->getForm();
+                if (form < 0 || form >= 3 || state > 2) continue;
+                // 贴图已按当前格子尺寸预先缩放，一比一绘制
+                painter.drawPixmap(topX + j * blockWidth + spriteMargin, topY + i * blockHeight + spriteMargin,
+                                   textures.pixmap(blockTextureFiles[form][state - 1]));
+            }
         }
     }
+    drawAnimations(painter);
     drawProps(painter);
-    QRectF playerRect = player->getCord();
-    painter.drawPixmap(playerRect.x() + 2, playerRect.y() + 2, 46, 46, playerPixmap);
+    QPointF playerPos = playerDrawPos();
+    painter.drawPixmap(QPointF(playerPos.x() + spriteMargin, playerPos.y() + spriteMargin), textures.pixmap(playerTextureFile));
     drawLinkPath(painter);
+    latency.frameFinished();
 }
 
 // 键盘按键事件
 void SimpleMode::keyPressEvent(QKeyEvent* event)
 {
-    if (event->key() == Qt::Key_W || event->key() == Qt::Key_Up) handleMove(0, -1);
-    else if (event->key() == Qt::Key_S || event->key() == Qt::Key_Down) handleMove(0, 1);
-    else if (event->key() == Qt::Key_A || event->key() == Qt::Key_Left) handleMove(-1, 0);
-    else if (event->key() == Qt::Key_D || event->key() == Qt::Key_Right) handleMove(1, 0);
+    if (finished) return; // 对局结束后只等待关闭结束弹窗
+    // 撤销、快速存档等命令立即执行，执行前先完成已排队的输入，保持按键顺序
+    bool command = event->matches(QKeySequence::Undo) || event->matches(QKeySequence::Redo)
+                   || event->key() == Qt::Key_F5 || event->key() == Qt::Key_F9;
+    if (command && simulation.hasPending()) simulate();
+    if (event->matches(QKeySequence::Undo)) { undo(); return; }
+    // F5快速存档，F9快速读档，按住Shift使用第二个存档槽
+    int quickSlot = event->modifiers() & Qt::ShiftModifier ? 1 : 0;
+    if (event->key() == Qt::Key_F5) { quickSave(quickSlot); return; }
+    if (event->key() == Qt::Key_F9) { quickLoad(quickSlot); return; }
+    if (event->matches(QKeySequence::Redo)) { redo(); return; }
+    simulation.postKey(event->key(), latency.stamp());
+    scheduleStep();
+}
+
+// 有输入排队时在下一个步边界安排一步模拟
+void SimpleMode::scheduleStep() {
+    if (!scheduler->isScheduled(GameTimer::Step))
+        scheduler->schedule(GameTimer::Step, SimulationLoop::delayToNextStep(scheduler->now()));
+}
+
+// 执行一步模拟
+// 按到达顺序执行排队的输入并交给录制器，玩家换格时开始插值动画，最后只请求一次重绘
+void SimpleMode::simulate() {
+    scheduler->cancel(GameTimer::Step);
+    const QPoint from(player->getXInMap(), player->getYInMap());
+    for (const QueuedInput& input : simulation.take()) {
+        if (finished) break;
+        latency.inputReceived(input.stamp);
+        if (input.type == ReplayEventType::Key) {
+            recorder.recordKey(input.value);
+            handleKey(input.value);
+        } else {
+            recorder.recordClick(input.cell());
+            handleClick(input.cell().x(), input.cell().y());
+        }
+    }
+    const QPoint to(player->getXInMap(), player->getYInMap());
+    if (to != from) {
+        animations->stop(AnimationType::PlayerSlide);
+        if (Animation* slide = animations->start(AnimationType::PlayerSlide, simulationStep)) {
+            slide->points[0] = from;
+            slide->points[1] = to;
+            slide->pointCount = 2;
+            slide->form = 1;
+        }
+    }
+    update();
+}
+
+// 玩家的绘制位置
+// 插值动画播放时按显示帧的进度从上一格移向当前格，否则就是玩家所在的格子
+QPointF SimpleMode::playerDrawPos() {
+    for (const Animation& anim : animations->animations()) {
+        if (!anim.active || anim.type != AnimationType::PlayerSlide) continue;
+        QPointF from(topX + anim.points[0].x() * blockWidth, topY + anim.points[0].y() * blockHeight);
+        QPointF to(topX + anim.points[1].x() * blockWidth, topY + anim.points[1].y() * blockHeight);
+        return from + (to - from) * anim.progress;
+    }
+    return player->getCord().topLeft();
+}
+
+// 处理按键
+// key: Qt::Key
+void SimpleMode::handleKey(int key)
+{
+    if (key == Qt::Key_W || key == Qt::Key_Up) handleMove(0, -1);
+    else if (key == Qt::Key_S || key == Qt::Key_Down) handleMove(0, 1);
+    else if (key == Qt::Key_A || key == Qt::Key_Left) handleMove(-1, 0);
+    else if (key == Qt::Key_D || key == Qt::Key_Right) handleMove(1, 0);
 }
 
 // 玩家移动后检测道具
@@ -333,8 +534,9 @@ void SimpleMode::handleMove(int dx, int dy) {
     player->setXInMap(nx);
     player->setYInMap(ny);
     player->getCord().moveTo(topX + nx * blockWidth, topY + ny * blockHeight);
+    latency.classify(InputAction::Move);
     qDebug() << "玩家移动到: 地图坐标(" << nx << "," << ny << ") 像素坐标(" << player->getCord().x() << "," << player->getCord().y() << ")";
-    checkPropCollision();
+    emit gameEvent(GameEvent::playerMoved(1, QPoint(nx, ny)));
     update();
 }
 
@@ -342,6 +544,7 @@ void SimpleMode::handleMove(int dx, int dy) {
 void SimpleMode::tryActivateBlock(int bx, int by)
 {
     linkPath.clear();
+    latency.classify(InputAction::Activate);
     Block* blk = blocks[by][bx];
     if (!player->getActive()) {
         blk->setState(2);
@@ -374,6 +577,7 @@ void SimpleMode::tryActivateBlock(int bx, int by)
             if (canEliminate(activeBlock, blk)) {
                 player -> setActive(false);
                 activeBlock = nullptr;
+                recordStep();
             } else {
                 activeBlock->setState(1);
                 blk->setState(2);
@@ -394,144 +598,66 @@ bool SimpleMode::canEliminate(Block* block1, Block* block2) {
     int y2 = block2->getMapY();
     qDebug() << "canEliminate: block1 mapXY(" << x1 << "," << y1 << ") block2 mapXY(" << x2 << "," << y2 << ")";
     if (block1->getForm() == block2->getForm() && canLink(x1, y1, x2, y2, &linkPath)) {
+        latency.classify(InputAction::Eliminate);
+        // 路径淡出，两个方块弹出后消失
+        if (Animation* fade = animations->start(AnimationType::PathFade, 400)) {
+            fade->pointCount = std::min(int(linkPath.size()), 4);
+            for (int k = 0; k < fade->pointCount; ++k) fade->points[k] = linkPath[k];
+        }
+        for (Block* blk : {block1, block2}) {
+            if (Animation* pop = animations->start(AnimationType::BlockPop, 250)) {
+                pop->points[0] = QPoint(blk->getMapX(), blk->getMapY());
+                pop->pointCount = 1;
+                pop->form = blk->getForm();
+            }
+        }
         block1->setState(0);
         block2->setState(0);
         updateScore(2);
-        if (hintActive) {
-            if (!isHintPairValid()) {
-                qDebug() << "当前Hint方块对被消除，寻找下一对";
-                findHintPair();
-            }
-        }
         update();
-        checkGameOver();
+        emit gameEvent(GameEvent::cellsCleared(QPoint(x1, y1), QPoint(x2, y2), 1));
         return true;
     }
     return false;
 }
 
 // 判断两方块是否可以通过直线连接
+// 规则见PackedBoard，游戏窗口和后台查找共用
 bool SimpleMode::canLinkInLine(int x1, int y1, int x2, int y2)
 {
-    if (x1 == x2) {
-		if (std::abs(y1 - y2) == 1) return true;
-        for (int y = std::min(y1, y2) + 1; y < std::max(y1, y2); ++y) {
-            if (blocks[y][x1]->getState() != 0) {
-                return false;
-            }
-		}
-		return true;
-    } else if (y1 == y2) {
-		if (std::abs(x1 - x2) == 1) return true;
-        for (int x = std::min(x1, x2) + 1; x < std::max(x1, x2); ++x) {
-            if (blocks[y1][x]->getState() != 0) {
-                return false;
-            }
-        }
-        return true;
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLinkInLine(x1, y1, x2, y2);
 }
 
 // 判断两方块是否可以通过一个拐点连接
 bool SimpleMode::canLinkWithOneCorner(int x1, int y1, int x2, int y2, QVector<QPoint>* path) {
-    if (blocks[y2][x1]->getState() == 0 &&
-        canLinkInLine(x1, y1, x1, y2) &&
-        canLinkInLine(x1, y2, x2, y2)) {
-        if (path) {
-            path->clear();
-            path->append(QPoint(x1, y1));
-            path->append(QPoint(x1, y2));
-            path->append(QPoint(x2, y2));
-        }
-        return true;
-    }
-    if (blocks[y1][x2]->getState() == 0 &&
-        canLinkInLine(x1, y1, x2, y1) &&
-        canLinkInLine(x2, y1, x2, y2)) {
-        if (path) {
-            path->clear();
-            path->append(QPoint(x1, y1));
-            path->append(QPoint(x2, y1));
-            path->append(QPoint(x2, y2));
-        }
-        return true;
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLinkWithOneCorner(x1, y1, x2, y2, path);
 }
 
 // 判断两方块是否可以通过两个拐点连接
 bool SimpleMode::canLinkWithTwoCorners(int x1, int y1, int x2, int y2, QVector<QPoint>* path) {
-    for (int i = 0; i < rows; ++i) {
-        if (i == y1 || i == y2) continue;
-        if (blocks[i][x1]->getState() == 0 && blocks[i][x2]->getState() == 0 &&
-            canLinkInLine(x1, y1, x1, i) &&
-            canLinkInLine(x1, i, x2, i) &&
-            canLinkInLine(x2, i, x2, y2)) {
-            if (path) {
-                path->clear();
-                path->append(QPoint(x1, y1));
-                path->append(QPoint(x1, i));
-                path->append(QPoint(x2, i));
-                path->append(QPoint(x2, y2));
-            }
-            return true;
-        }
-    }
-    for (int j = 0; j < cols; ++j) {
-        if (j == x1 || j == x2) continue;
-        if (blocks[y1][j]->getState() == 0 && blocks[y2][j]->getState() == 0 &&
-            canLinkInLine(x1, y1, j, y1) &&
-            canLinkInLine(j, y1, j, y2) &&
-            canLinkInLine(j, y2, x2, y2)) {
-            if (path) {
-                path->clear();
-                path->append(QPoint(x1, y1));
-                path->append(QPoint(j, y1));
-                path->append(QPoint(j, y2));
-                path->append(QPoint(x2, y2));
-            }
-            return true;
-        }
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLinkWithTwoCorners(x1, y1, x2, y2, path);
 }
 
 // 判断两方块是否可以连接
 bool SimpleMode::canLink(int x1, int y1, int x2, int y2, QVector<QPoint>* path) {
-    if (canLinkInLine(x1, y1, x2, y2)) {
-        if (path) {
-            path->clear();
-            path->append(QPoint(x1, y1));
-            path->append(QPoint(x2, y2));
-        }
-        return true;
-    }
-    if (canLinkWithOneCorner(x1, y1, x2, y2, path)) {
-        return true;
-    }
-    if (canLinkWithTwoCorners(x1, y1, x2, y2, path)) {
-        return true;
-    }
-    return false;
+    return PackedBoard(packedCells, rows, cols).canLink(x1, y1, x2, y2, path);
 }
 
 // 退出按钮点击槽函数
 void SimpleMode::on_exitBtn_clicked()
 {
-    progressTimer->stop();
+    scheduler->clear();
+    autosaver.discard();
     emit exitToMenu();
     this->close();
 }
 
 // 暂停游戏
 void SimpleMode::pauseGame() {
-    if (isPaused) return;
+    if (isPaused || finished) return;
     isPaused = true;
-    if (progressTimer) progressTimer->stop();
-    if (propTimer) propTimer->stop();
-    if (hintTimer) hintTimer->stop();
-    if (flashTimer) flashTimer->stop();
+    scheduler->pause(); // 游戏时钟停走，各定时事件保留剩余时间
+    autosave(true);
     setEnabled(false);
     pauseMenu = new PauseMenu(this);
     connect(pauseMenu, &PauseMenu::continueClicked, this, &SimpleMode::onContinueBtnClicked);
@@ -544,10 +670,7 @@ void SimpleMode::pauseGame() {
 // 恢复游戏
 void SimpleMode::resumeGame() {
     isPaused = false;
-    if (progressTimer) progressTimer->start();
-    if (propTimer) propTimer->start();
-    if (hintTimer && hintActive) hintTimer->start();
-    if (flashTimer && flashActive) flashTimer->start();
+    scheduler->resume();
     setEnabled(true);
     if (pauseMenu) pauseMenu->close();
 }
@@ -556,21 +679,29 @@ void SimpleMode::resumeGame() {
 void SimpleMode::onContinueBtnClicked() { resumeGame(); }
 
 // 暂停菜单退出按钮点击槽函数
-void SimpleMode::onExitBtnClicked() { if (pauseMenu) pauseMenu->close(); close(); }
+void SimpleMode::onExitBtnClicked() { if (pauseMenu) pauseMenu->close(); autosaver.discard(); close(); }
 
 // 暂停菜单保存按钮点击槽函数
 void SimpleMode::onSaveBtnClicked() {
-    QString path = QFileDialog::getSaveFileName(this, "保存存档", "", "存档文件 (*.txt)");
-    if (!path.isEmpty()) saveGame(path, getSaveData());
+    QString name = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".qsav";
+    QString path = QFileDialog::getSaveFileName(this, "保存存档", SaveLibrary::directory() + "/" + name, "存档文件 (*.qsav)");
+    if (!path.isEmpty()) SaveLibrary::instance()->save(path, getSaveData());
 }
 
 // 暂停菜单加载按钮点击槽函数
 void SimpleMode::onLoadBtnClicked() {
-    QString path = QFileDialog::getOpenFileName(this, "读取存档", "", "存档文件 (*.txt)");
+    const GameMode mode = GameMode::Single;
+    SaveBrowser browser(this, &mode);
+    QString path = browser.exec() == QDialog::Accepted ? browser.selectedPath() : QString();
     if (!path.isEmpty()) {
         SaveData data;
         if (loadGame(path, data) && data.mode == GameMode::Single) {
             applySaveData(data);
+            recorder.cancel(); // 读档后的对局无法从种子复现
+            history.reset(undoStep());
+            if (practice && !headless) scheduler->schedule(GameTimer::Progress, 1000, 1000); // 练习局停止的倒计时重新开始
+            practice = false;
+            autosave(true);
             resumeGame();
             if (pauseMenu) pauseMenu->close();
         } else {
@@ -579,6 +710,15 @@ void SimpleMode::onLoadBtnClicked() {
     }
 }
 
+// 自动存档
+// snapshot: true时写入完整快照并清空旧日志，false时只追加新增的日志记录
+void SimpleMode::autosave(bool snapshot) {
+    QByteArray records = journal.takePending();
+    if (headless) return; // 重放不写自动存档
+    if (snapshot) autosaver.submit(getSaveData()); // 快照已包含这些记录的效果
+    else autosaver.append(records);
+}
+
 // 获取存档数据
 SaveData SimpleMode::getSaveData() const {
     SaveData data;
@@ -589,69 +729,64 @@ SaveData SimpleMode::getSaveData() const {
     data.player1Pos = QPoint(player->getXInMap(), player->getYInMap());
     data.player2Pos = QPoint(-1, -1);
     data.blockTextureIds = blockTextureIds;
-    data.blockForms = QVector<QVector<int>>(rows, QVector<int>(cols));
-    data.blockStates = QVector<QVector<int>>(rows, QVector<int>(cols));
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j) {
-            data.blockForms[i][j] = blocks[i][j] ? blocks[i][j]->getForm() : -1;
-            data.blockStates[i][j] = blocks[i][j] ? blocks[i][j]->getState() : 0;
-        }
+    data.rows = rows;
+    data.cols = cols;
+    data.cells = packedBoard();
     data.propPositions.clear();
     data.propTypes.clear();
-    for (Item* prop : props) {
-        if (prop->isVisible()) {
-            data.propPositions.append(prop->getMapPos());
-            data.propTypes.append(static_cast<int>(prop->getType()));
-        }
+    for (const Item& prop : props) {
+        data.propPositions.append(prop.getMapPos());
+        data.propTypes.append(static_cast<int>(prop.getType()));
     }
     return data;
 }
 
 // 应用存档数据
 void SimpleMode::applySaveData(const SaveData& data) {
-    timeLeft = data.timeLeft;
-    score = data.score1;
-    player->setXInMap(data.player1Pos.x());
-    player->setYInMap(data.player1Pos.y());
-    player->getCord().moveTo(topX + data.player1Pos.x() * blockWidth, topY + data.player1Pos.y() * blockHeight);
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j) {
-            if (blocks[i][j]) {
-                blocks[i][j]->setForm(data.blockForms[i][j]);
-                blocks[i][j]->setState(data.blockStates[i][j]);
-            }
+    applyBoardState(GameSnapshot::fromSaveData(data));
+}
+
+// 恢复快照中的棋盘、分数、时间、玩家和道具
+// snapshot: 局面快照
+// 压缩棋盘整块保存，只重写与当前局面不同的格子
+void SimpleMode::applyBoardState(const GameSnapshot& snapshot) {
+    simulation.clear(); // 排队的输入针对读档前的局面，不再执行
+    scheduler->cancel(GameTimer::Step);
+    timeLeft = snapshot.timeLeft;
+    score = snapshot.score1;
+    player->setXInMap(snapshot.player1.x());
+    player->setYInMap(snapshot.player1.y());
+    player->getCord().moveTo(topX + snapshot.player1.x() * blockWidth, topY + snapshot.player1.y() * blockHeight);
+    QByteArray current = packedBoard();
+    for (int i = 0; i < std::min(rows, snapshot.rows); ++i)
+        for (int j = 0; j < std::min(cols, snapshot.cols); ++j) {
+            char cell = snapshot.cells[i * snapshot.cols + j];
+            if (!blocks[i][j] || cell == current[i * cols + j]) continue;
+            // 压缩编码不保留已消除格子的形状
+            if (packedState(uchar(cell)) != 0) blocks[i][j]->setForm(packedForm(uchar(cell)));
+            blocks[i][j]->setState(packedState(uchar(cell)));
         }
-    for (Item* prop : props) delete prop;
     props.clear();
-    for (int i = 0; i < data.propPositions.size(); ++i) {
-        QRectF rect(topX + data.propPositions[i].x() * blockWidth, topY + data.propPositions[i].y() * blockHeight, blockWidth, blockHeight);
-        QPixmap pix;
-        ItemType type = static_cast<ItemType>(data.propTypes[i]);
-        switch (type) {
-            case ItemType::AddTime: pix = QPixmap(":/images/images/Time.png"); break;
-            case ItemType::Shuffle: pix = QPixmap(":/images/images/Shuffle.png"); break;
-            case ItemType::Hint:    pix = QPixmap(":/images/images/Hint.png"); break;
-            case ItemType::Flash:   pix = QPixmap(":/images/images/Flash.png"); break;
-            default: break;
-        }
-        Item* prop = new Item(type, data.propPositions[i], rect, pix);
-        props.append(prop);
+    for (int i = 0; i < snapshot.propPositions.size(); ++i) {
+        QRectF rect(topX + snapshot.propPositions[i].x() * blockWidth, topY + snapshot.propPositions[i].y() * blockHeight, blockWidth, blockHeight);
+        ItemType type = static_cast<ItemType>(snapshot.propTypes[i]);
+        props.add(type, snapshot.propPositions[i], rect, textures.pixmap(itemTextureFile(type)));
     }
-    updateScoreLabel();
+    emit gameEvent(GameEvent::boardReset(snapshot.player1, QPoint(-1, -1), timeLeft));
     update();
 }
 
 // 检查道具碰撞
 void SimpleMode::checkPropCollision() {
     QPoint playerPos(player->getXInMap(), player->getYInMap());
-    for (Item* prop : props) {
-        if (prop->isVisible()) {
-            if (prop->getMapPos() == playerPos) {
-                triggerPropEffect(prop->getType());
-                prop->setVisible(false);
-            }
-        }
-    }
+    PropHandle handle = props.handleAt(playerPos);
+    Item* prop = props.get(handle);
+    if (!prop) return;
+    // 先回收再触发效果，洗牌等效果看到的是拾取后的局面
+    ItemType type = prop->getType();
+    props.remove(handle);
+    emit gameEvent(GameEvent::propCollected(1, playerPos, type));
+    triggerPropEffect(type);
 }
 
 // 触发道具效果
@@ -661,72 +796,117 @@ void SimpleMode::triggerPropEffect(ItemType type) {
         case ItemType::AddTime:
             timeLeft += 30;
             if (timeLeft > maxTime) timeLeft = maxTime;
-            progressBar->setValue(timeLeft);
+            emit gameEvent(GameEvent::timeChanged(timeLeft));
             break;
-        case ItemType::Shuffle:
-            shuffle();
+        case ItemType::Shuffle: {
+            quint32 shuffleSeed = rng.generate();
+            shuffle(shuffleSeed);
+            emit gameEvent(GameEvent::shuffled(shuffleSeed));
+            recordStep();
             break;
-        case ItemType::Hint:
-            hintActive = true;
-            findHintPair();
-            hintTimer->start(10000);
-            break;
-        case ItemType::Flash:
-            flashActive = true;
-            flashTimer->start(5000);
+        }
+        default:
+            startEffect(type, 1);
             break;
-        default: break;
     }
     update();
 }
 
-// 检查当前高亮的Hint方块对是否仍然有效
-// 返回值: 如果Hint方块对仍然可以消除则返回true，否则返回false
-bool SimpleMode::isHintPairValid() {
-    if (hintBlock1 == QPoint(-1, -1) || hintBlock2 == QPoint(-1, -1)) return false;
-    Block* b1 = blocks[hintBlock1.y()][hintBlock1.x()];
-    Block* b2 = blocks[hintBlock2.y()][hintBlock2.x()];
-    if (!b1 || !b2 || b1->getState() == 0 || b2->getState() == 0) return false;
-    return b1->getForm() == b2->getForm() && canLink(b1->getMapX(), b1->getMapY(), b2->getMapX(), b2->getMapY());
+// 同步查找Hint方块对
+// 无窗口重放时使用，有窗口时由后台线程查找
+void SimpleMode::findHintPair() {
+    findLinkPair(packedCells, rows, cols, hintBlock1, hintBlock2);
 }
 
-// 查找可消除的方块对用于Hint提示
-void SimpleMode::findHintPair() {
-    for (int i = 2; i < rows-2; ++i) {
-        for (int j = 2; j < cols-2; ++j) {
-            Block* b1 = blocks[i][j];
-            if (!b1 || b1->getState() == 0) continue;
-            for (int ii = 2; ii < rows-2; ++ii) {
-                for (int jj = 2; jj < cols-2; ++jj) {
-                    if (i == ii && j == jj) continue;
-                    Block* b2 = blocks[ii][jj];
-                    if (!b2 || b2->getState() == 0) continue;
-                    if (b1->getForm() == b2->getForm() && canLink(b1->getMapX(), b1->getMapY(), b2->getMapX(), b2->getMapY())) {
-                        hintBlock1 = QPoint(j, i);
-                        hintBlock2 = QPoint(jj, ii);
-                        return;
-                    }
-                }
-            }
-        }
+// 棋盘变化后更新Hint方块对
+// 有窗口时把棋盘交给后台线程预先查找，Hint道具生效时直接读取结果；无窗口时只在需要显示时同步查找
+void SimpleMode::updateHint() {
+    if (headless) {
+        if (effects.isActive(ItemType::Hint) && hintBlock1 == QPoint(-1, -1)) findHintPair();
+        return;
     }
-    hintBlock1 = QPoint(-1, -1);
-    hintBlock2 = QPoint(-1, -1);
+    hintSolver.submit(packedCells, rows, cols);
+}
+
+// 后台查找完成
+// a, b: 可消除的方块对，没有时都为(-1,-1)
+// 没有可消除对说明棋盘成了死局，处理方式先交给录制器，重放时按记录执行，不依赖策略和查找时机
+void SimpleMode::onHintSolved(const QPoint& a, const QPoint& b) {
+    if (a != QPoint(-1, -1)) {
+        showHint(a, b);
+        return;
+    }
+    if (finished) return;
+    const ReplayTick outcome = deadBoardOutcome();
+    recorder.recordTick(outcome);
+    resolveDeadBoard(outcome);
+}
+
+// 棋盘上是否已没有方块
+bool SimpleMode::boardCleared() const {
+    for (int i = 2; i < rows - 2; ++i)
+        for (int j = 2; j < cols - 2; ++j)
+            if (blocks[i][j] && blocks[i][j]->getState() != 0) return false;
+    return true;
+}
+
+// 按策略决定死局的处理方式
+// 棋盘已清空、策略为直接结束或连续洗牌次数用完时结束对局，否则洗牌
+ReplayTick SimpleMode::deadBoardOutcome() const {
+    if (boardCleared() || deadBoardPolicy == DeadBoardPolicy::End || deadShuffles >= deadBoardShuffleLimit)
+        return ReplayTick::DeadEnd;
+    return ReplayTick::DeadShuffle;
+}
+
+// 处理死局
+// outcome: DeadShuffle或DeadEnd
+// 洗牌后棋盘变化会重新提交查找，仍是死局时再次进入这里
+void SimpleMode::resolveDeadBoard(ReplayTick outcome) {
+    if (outcome == ReplayTick::DeadEnd) {
+        finishGame(QString("游戏结束！最终分数：%1").arg(score));
+        return;
+    }
+    ++deadShuffles;
+    quint32 shuffleSeed = rng.generate();
+    shuffle(shuffleSeed);
+    emit gameEvent(GameEvent::shuffled(shuffleSeed));
+    recordStep();
+    update();
+}
+
+// Hint生效时显示找到的方块对
+// a, b: 可消除的方块对
+// 没有显示中的方块对时才采用，仍然有效的方块对不会被替换
+void SimpleMode::showHint(const QPoint& a, const QPoint& b) {
+    if (!effects.isActive(ItemType::Hint) || hintBlock1 != QPoint(-1, -1)) return;
+    hintBlock1 = a;
+    hintBlock2 = b;
+    update();
 }
 
 // 鼠标点击事件处理
 // event: 鼠标事件指针
 void SimpleMode::mousePressEvent(QMouseEvent* event) {
-    if (!flashActive) return;
+    if (finished) return;
+    if (!effects.isActive(ItemType::Flash, 1)) return;
     QPoint pos = event->pos();
     int mx = (pos.x() - topX) / blockWidth;
     int my = (pos.y() - topY) / blockHeight;
+    simulation.postClick(QPoint(mx, my), latency.stamp());
+    scheduleStep();
+}
+
+// 处理Flash道具下的点击
+// mx, my: 点击的地图坐标
+void SimpleMode::handleClick(int mx, int my) {
+    if (!effects.isActive(ItemType::Flash, 1)) return;
     if (mx < 0 || mx >= rows || my < 0 || my >= cols) return;
     if (!blocks[my][mx] || blocks[my][mx]->getState() == 0) {
         player->setXInMap(mx);
         player->setYInMap(my);
         player->getCord().moveTo(topX + mx * blockWidth, topY + my * blockHeight);
-        checkPropCollision();
+        latency.classify(InputAction::Move);
+        emit gameEvent(GameEvent::playerMoved(1, QPoint(mx, my)));
         update();
     } else {
         static const int dx[4] = {0, 0, -1, 1};
@@ -738,7 +918,7 @@ void SimpleMode::mousePressEvent(QMouseEvent* event) {
                 player->setYInMap(ny);
                 player->getCord().moveTo(topX + nx * blockWidth, topY + ny * blockHeight);
                 tryActivateBlock(mx, my);
-                checkPropCollision();
+                emit gameEvent(GameEvent::playerMoved(1, QPoint(nx, ny)));
                 update();
                 break;
             }
@@ -746,12 +926,327 @@ void SimpleMode::mousePressEvent(QMouseEvent* event) {
     }
 }
 
+// 开始持续型道具效果
+// type: 道具类型
+// playerId: 拾取道具的玩家
+// 作用对象和持续时间查登记表，重放时不计时，由录制的结束事件结束
+void SimpleMode::startEffect(ItemType type, int playerId) {
+    const EffectSpec* spec = effectSpec(type);
+    if (!spec || spec->target == EffectTarget::Instant) return;
+    const int target = spec->targetOf(playerId);
+    effects.apply(type, target, headless ? -1 : scheduler->now() + spec->duration);
+    armEffects();
+    if (type == ItemType::Hint) {
+        // 有窗口时直接读取后台预先算好的结果，还没算完时由送回的结果显示，没有提交过时现在提交
+        if (hintSolver.isReady()) showHint(hintSolver.first(), hintSolver.second());
+        else if (headless) findHintPair();
+        else if (!hintSolver.isPending()) updateHint();
+        animations->stop(AnimationType::HintPulse);
+        animations->start(AnimationType::HintPulse, 0);
+    }
+    emit gameEvent(GameEvent::effectStarted(target, type));
+}
+
+// 结束道具效果
+// type: 道具类型
+// playerId: 受影响的玩家，0表示整个棋盘
+// 叠加的同类记录一并结束
+void SimpleMode::endEffect(ItemType type, int playerId) {
+    effects.end(type, playerId);
+    armEffects();
+    if (type == ItemType::Hint) {
+        hintBlock1 = QPoint(-1, -1);
+        hintBlock2 = QPoint(-1, -1);
+        animations->stop(AnimationType::HintPulse);
+    }
+    emit gameEvent(GameEvent::effectEnded(playerId, type));
+    update();
+}
+
+// 按最早到期的道具效果安排调度器
+void SimpleMode::armEffects() {
+    const qint64 next = effects.nextExpiry();
+    if (next < 0) scheduler->cancel(GameTimer::Effect);
+    else scheduler->schedule(GameTimer::Effect, next - scheduler->now());
+}
+
+// 处理状态变化
+// event: 游戏逻辑发出的状态变化
+// 只做与这次变化有关的增量工作
+void SimpleMode::onGameEvent(const GameEvent& event) {
+    switch (event.type) {
+        case GameEventType::ScoreChanged:
+            updateScoreLabel();
+            break;
+        case GameEventType::BoardReset:
+            syncPackedCells();
+            rebuildFreeCells();
+            hintBlock1 = hintBlock2 = QPoint(-1, -1);
+            updateHint();
+            updateScoreLabel();
+            break;
+        case GameEventType::TimeChanged:
+            progressBar->setValue(timeLeft);
+            if (!practice) progressBar->setFormat(QString::number(timeLeft) + "s");
+            break;
+        case GameEventType::PlayerMoved:
+            checkPropCollision();
+            break;
+        case GameEventType::CellsCleared:
+            for (const QPoint& cell : {event.a, event.b})
+                packedCells[cell.y() * cols + cell.x()] = char(packBlock(blocks[cell.y()][cell.x()]->getForm(), 0));
+            freeCells.insert(event.a);
+            freeCells.insert(event.b);
+            // 消除只会让路径更通畅，Hint方块对只有自身被消除时才失效
+            if (effects.isActive(ItemType::Hint) && (event.a == hintBlock1 || event.a == hintBlock2 || event.b == hintBlock1 || event.b == hintBlock2)) {
+                qDebug() << "当前Hint方块对被消除，寻找下一对";
+                hintBlock1 = hintBlock2 = QPoint(-1, -1);
+            }
+            deadShuffles = 0;
+            updateHint();
+            break;
+        case GameEventType::Shuffled:
+            syncPackedCells();
+            rebuildFreeCells();
+            hintBlock1 = hintBlock2 = QPoint(-1, -1);
+            updateHint();
+            break;
+        case GameEventType::PropSpawned:
+            freeCells.remove(event.a);
+            break;
+        case GameEventType::PropCollected:
+            freeCells.insert(event.a);
+            break;
+        default:
+            break;
+    }
+}
+
+// 调度器事件分发
+// id: 触发的定时事件
+// 影响对局的事件先交给录制器，重放时按记录的顺序直接调用
+void SimpleMode::onTimer(GameTimer id) {
+    switch (id) {
+        case GameTimer::Progress:
+            recorder.recordTick(ReplayTick::Progress);
+            progress();
+            break;
+        case GameTimer::Prop:
+            recorder.recordTick(ReplayTick::Prop);
+            generateProp();
+            break;
+        case GameTimer::Autosave:
+            autosave(true);
+            break;
+        case GameTimer::Step:
+            simulate();
+            break;
+        case GameTimer::Effect:
+            for (const StatusEffect& ended : effects.expire(scheduler->now())) {
+                recorder.recordTick(effectSpec(ended.type)->endTicks[ended.playerId]);
+                endEffect(ended.type, ended.playerId);
+            }
+            armEffects();
+            break;
+        default:
+            break;
+    }
+}
+
+// 执行一条重放事件
+// event: 录制的按键、点击或定时器事件
+// 对局结束后的事件不再执行，与有窗口时关闭后不再响应一致
+void SimpleMode::applyReplayEvent(const ReplayEvent& event) {
+    if (finished) return;
+    switch (event.type) {
+        case ReplayEventType::Key:
+            handleKey(event.value);
+            break;
+        case ReplayEventType::Click:
+            handleClick(event.cell().x(), event.cell().y());
+            break;
+        case ReplayEventType::Tick: {
+            const ReplayTick tick = static_cast<ReplayTick>(event.value);
+            ItemType type;
+            int playerId;
+            if (tick == ReplayTick::Progress) progress();
+            else if (tick == ReplayTick::Prop) generateProp();
+            else if (tick == ReplayTick::DeadShuffle || tick == ReplayTick::DeadEnd) resolveDeadBoard(tick);
+            else if (effectForTick(tick, type, playerId)) endEffect(type, playerId);
+            break;
+        }
+    }
+}
+
+// 用新种子重置对局随机数
+// 重放从关键帧开始模拟时只需要这个种子，不必保存随机数的内部状态
+void SimpleMode::markKeyframe() {
+    keyframeSeed = rng.generate();
+    rng.seed(keyframeSeed);
+    if (recorder.isRecording()) recorder.recordKeyframe(captureKeyframe());
+}
+
+// 保存当前局面快照
+GameSnapshot SimpleMode::captureSnapshot() const {
+    GameSnapshot snapshot;
+    snapshot.rows = rows;
+    snapshot.cols = cols;
+    snapshot.cells = packedBoard();
+    snapshot.timeLeft = timeLeft;
+    snapshot.score1 = score;
+    snapshot.player1 = QPoint(player->getXInMap(), player->getYInMap());
+    for (const Item& prop : props) {
+        snapshot.propPositions.append(prop.getMapPos());
+        snapshot.propTypes.append(static_cast<int>(prop.getType()));
+    }
+    snapshot.flags = effects.keyframeFlags();
+    snapshot.effects = effects.save(scheduler->now());
+    snapshot.timers = scheduler->save();
+    if (activeBlock) snapshot.active1 = QPoint(activeBlock->getMapX(), activeBlock->getMapY());
+    return snapshot;
+}
+
+// 恢复局面快照
+// snapshot: captureSnapshot保存的局面
+// 有窗口时道具效果、倒计时和道具生成都按快照中的剩余时间继续计时
+void SimpleMode::restoreSnapshot(const GameSnapshot& snapshot) {
+    applyBoardState(snapshot);
+    finished = false;
+    linkPath.clear();
+    // 关键帧没有定时事件记录，重放由录制的事件驱动，不改动调度器
+    if (!headless && !snapshot.timers.isEmpty()) {
+        scheduler->restore(snapshot.timers);
+        scheduler->cancel(GameTimer::Step); // 排队的输入已清空
+        if (practice) scheduler->cancel(GameTimer::Progress); // 练习局不计时
+    }
+    // 关键帧没有效果记录，按标志以完整时长计时
+    effects.restore(snapshot.effects, snapshot.flags, scheduler->now(), !headless);
+    armEffects();
+    hintBlock1 = hintBlock2 = QPoint(-1, -1);
+    updateHint();
+    const QPoint& active = snapshot.active1;
+    activeBlock = active.x() >= 0 && active.x() < cols && active.y() >= 0 && active.y() < rows ? blocks[active.y()][active.x()] : nullptr;
+    player->setActive(activeBlock != nullptr);
+    progressBar->setValue(timeLeft);
+    progressBar->setFormat(QString::number(timeLeft) + "s");
+    update();
+}
 
+// 保存当前状态为关键帧
+ReplayKeyframe SimpleMode::captureKeyframe() const {
+    ReplayKeyframe keyframe;
+    keyframe.seed = keyframeSeed;
+    keyframe.ticks = ticks;
+    keyframe.flags = effects.keyframeFlags();
+    if (activeBlock) keyframe.active1 = QPoint(activeBlock->getMapX(), activeBlock->getMapY());
+    keyframe.state = encodeSave(getSaveData());
+    return keyframe;
+}
 
+// 恢复到关键帧
+// keyframe: captureKeyframe保存的状态
+void SimpleMode::restoreKeyframe(const ReplayKeyframe& keyframe) {
+    SaveData data;
+    if (!decodeSave(keyframe.state, data)) return;
+    GameSnapshot snapshot = GameSnapshot::fromSaveData(data);
+    snapshot.flags = keyframe.flags;
+    snapshot.active1 = keyframe.active1;
+    restoreSnapshot(snapshot);
+    rng.seed(keyframe.seed);
+    keyframeSeed = keyframe.seed;
+    ticks = keyframe.ticks;
+}
 
+// 快速存档
+// slot: 存档槽编号
+void SimpleMode::quickSave(int slot) {
+    quickSlots.store(slot, captureSnapshot());
+    if (quickSlots.isMirrored()) quickSlots.mirror(slot, getSaveData());
+}
 
+// 快速读档
+// slot: 存档槽编号，槽为空时不做任何事
+void SimpleMode::quickLoad(int slot) {
+    if (finished) return; // 读档会清除结束标志，结束后不再允许
+    const GameSnapshot* snapshot = quickSlots.snapshot(slot);
+    if (!snapshot) return;
+    restoreSnapshot(*snapshot);
+    recorder.cancel(); // 读档后的对局无法从种子复现
+    history.reset(undoStep());
+    autosave(true);
+}
 
+// 生成当前局面的撤销步骤
+UndoStep SimpleMode::undoStep() const {
+    UndoStep step;
+    QByteArray cells = packedBoard();
+    step.board = history.isEmpty() ? BoardVersion(rows, cols, cells) : history.current().board.updated(cells);
+    step.score = score;
+    step.playerPos = QPoint(player->getXInMap(), player->getYInMap());
+    if (activeBlock) step.activePos = QPoint(activeBlock->getMapX(), activeBlock->getMapY());
+    for (const Item& prop : props) {
+        step.propPositions.append(prop.getMapPos());
+        step.propTypes.append(static_cast<int>(prop.getType()));
+    }
+    return step;
+}
 
+// 记录一个撤销步骤
+void SimpleMode::recordStep() {
+    if (!headless) history.push(undoStep());
+}
 
+// 切换到撤销步骤的局面
+// from: 当前局面的棋盘版本
+// step: 目标步骤
+// 只重写与当前局面不共享的行，撤销几千步之后也只改动变化过的格子
+void SimpleMode::applyStep(const BoardVersion& from, const UndoStep& step) {
+    for (int i = 0; i < std::min(rows, step.board.rows()); ++i) {
+        if (step.board.sharesRow(from, i)) continue;
+        for (int j = 0; j < std::min(cols, step.board.cols()); ++j) {
+            if (!blocks[i][j]) continue;
+            uchar cell = step.board.at(i, j);
+            if (packedState(cell) != 0) blocks[i][j]->setForm(packedForm(cell));
+            blocks[i][j]->setState(packedState(cell));
+        }
+    }
+    score = step.score;
+    player->setXInMap(step.playerPos.x());
+    player->setYInMap(step.playerPos.y());
+    player->getCord().moveTo(topX + step.playerPos.x() * blockWidth, topY + step.playerPos.y() * blockHeight);
+    activeBlock = step.activePos.x() >= 0 ? blocks[step.activePos.y()][step.activePos.x()] : nullptr;
+    player->setActive(activeBlock != nullptr);
+    props.clear();
+    for (int i = 0; i < step.propPositions.size(); ++i) {
+        QRectF rect(topX + step.propPositions[i].x() * blockWidth, topY + step.propPositions[i].y() * blockHeight, blockWidth, blockHeight);
+        ItemType type = static_cast<ItemType>(step.propTypes[i]);
+        props.add(type, step.propPositions[i], rect, textures.pixmap(itemTextureFile(type)));
+    }
+    linkPath.clear();
+    emit gameEvent(GameEvent::boardReset(step.playerPos, QPoint(-1, -1), timeLeft));
+    update();
+}
 
+// 撤销一步
+// 第一次撤销把对局转为练习局：停止倒计时，放弃录制
+void SimpleMode::undo() {
+    if (finished || !history.canUndo()) return;
+    if (!practice) {
+        practice = true;
+        scheduler->cancel(GameTimer::Progress);
+        progressBar->setFormat("练习");
+        recorder.cancel();
+    }
+    // 上一步之后的改动（如激活方块）不在历史中，先与当前步骤比较得到实际局面
+    BoardVersion live = history.current().board.updated(packedBoard());
+    applyStep(live, history.undo());
+    autosave(true);
+}
 
+// 重做一步
+void SimpleMode::redo() {
+    if (finished || !history.canRedo()) return;
+    BoardVersion live = history.current().board.updated(packedBoard());
+    applyStep(live, history.redo());
+    autosave(true);
+}
@@ -2,6 +2,14 @@
 #include <QTest>
 #include <QVector>
 #include <QPoint>
+#include <QRandomGenerator>
+#include "boardcodec.h"
+#include "replay.h"
+#include "savebrowser.h"
+#include "tilerenderer.h"
+#include <QTemporaryDir>
+#include <QFile>
+#include <QStandardPaths>
 
 SimpleMode* SimpleTest::createTestSimpleMode() {
     return new SimpleMode(nullptr);
@@ -21,6 +29,12 @@ void SimpleTest::setupTestLayout(T* mode, const int layout[14][14]) {
             }
         }
     }
+    mode->syncPackedCells(); // 直接改动方块不会发出事件，手动更新压缩棋盘缓存
+}
+
+// 所有测试开始前执行
+void SimpleTest::initTestCase() {
+    QStandardPaths::setTestModeEnabled(true);
 }
 
 // 测试单人模式的直线连接判定
@@ -325,4 +339,877 @@ void SimpleTest::testDuoModeCanLink() {
     delete mode;
 }
 
+// 测试单人模式的输入延迟
+// 每轮从左上角出发：右移两步、下移一步，撞向(2,2)激活方块，
+// 再右移一步撞向(3,2)消除这一对，随后恢复两个方块进入下一轮
+void SimpleTest::testSimpleModeInputLatency() {
+    SimpleMode* mode = createTestSimpleMode();
+    mode->props.clear();
+    mode->blocks[2][2]->setForm(0);
+    mode->blocks[2][3]->setForm(0);
+    mode->syncPackedCells();
+    mode->show();
+    if (!QTest::qWaitForWindowExposed(mode)) {
+        delete mode;
+        QSKIP("窗口无法显示，跳过输入延迟测试");
+    }
+
+    const Qt::Key keys[] = {Qt::Key_D, Qt::Key_D, Qt::Key_S, Qt::Key_S, Qt::Key_D, Qt::Key_S};
+    for (int round = 0; round < 50; ++round) {
+        mode->blocks[2][2]->setState(1);
+        mode->blocks[2][3]->setState(1);
+        mode->syncPackedCells();
+        mode->player->setXInMap(0);
+        mode->player->setYInMap(0);
+        mode->player->getCord().moveTo(mode->topX, mode->topY);
+        for (Qt::Key key : keys) {
+            QTest::keyClick(mode, key);
+            // 按键先进入模拟队列，等它在下一步执行完再发下一个键或重置棋盘
+            // 因此测得的延迟包含最多一个simulationStep的排队时间
+            QVERIFY(QTest::qWaitFor([mode]() { return !mode->simulation.hasPending(); }, 1000));
+        }
+    }
+
+    qInfo().noquote() << mode->latency.report();
+    for (InputAction action : {InputAction::Move, InputAction::Activate, InputAction::Eliminate}) {
+        QVERIFY(mode->latency.sampleCount(action) > 0);
+        QVERIFY(mode->latency.percentile(action, 95) < 100000);
+    }
+
+    delete mode;
+}
+
+// 测试二进制存档格式
+void SimpleTest::testBinarySaveFormat() {
+    SimpleMode* mode = createTestSimpleMode();
+    SaveData original = mode->getSaveData();
+    original.propPositions.append(QPoint(1, 0));
+    original.propTypes.append(static_cast<int>(ItemType::Hint));
+    QByteArray bytes = encodeSave(original);
+    QVERIFY(bytes.startsWith("QLNK"));
+
+    // 往返一致
+    SaveData decoded;
+    QVERIFY(decodeSave(bytes, decoded));
+    QCOMPARE(decoded.mode, original.mode);
+    QCOMPARE(decoded.timeLeft, original.timeLeft);
+    QCOMPARE(decoded.score1, original.score1);
+    QCOMPARE(decoded.player1Pos, original.player1Pos);
+    QCOMPARE(decoded.player2Pos, original.player2Pos);
+    QCOMPARE(decoded.blockTextureIds, original.blockTextureIds);
+    QCOMPARE(decoded.cells, original.cells);
+    QCOMPARE(decoded.propPositions, original.propPositions);
+    QCOMPARE(decoded.propTypes, original.propTypes);
+
+    // 截断的存档
+    for (int size = 0; size < bytes.size(); size += 7)
+        QVERIFY(!decodeSave(bytes.left(size), decoded));
+
+    // 篡改的存档
+    QByteArray corrupted = bytes;
+    corrupted[40] = char(corrupted[40] ^ 0x01);
+    QVERIFY(!decodeSave(corrupted, decoded));
+
+    delete mode;
+}
+
+// 测试对局日志重放
+void SimpleTest::testJournalReplay() {
+    SimpleMode* mode = createTestSimpleMode();
+    mode->journal.takePending();
+    SaveData base = mode->getSaveData();
+
+    mode->triggerPropEffect(ItemType::Shuffle);
+    mode->player->setXInMap(1);
+    mode->player->setYInMap(0);
+    mode->journal.recordMove(1, QPoint(1, 0));
+    mode->journal.recordTime(42);
+    QByteArray records = mode->journal.takePending();
+    QVERIFY(records.size() < 32);
+
+    QVERIFY(MoveJournal::replay(records, base));
+    QCOMPARE(base.cells, mode->packedBoard());
+    QCOMPARE(base.player1Pos, QPoint(1, 0));
+    QCOMPARE(base.timeLeft, 42);
+
+    // 末尾被截断的记录不生效
+    SaveData truncated = mode->getSaveData();
+    QVERIFY(!MoveJournal::replay(records.left(records.size() - 1), truncated));
+
+    delete mode;
+}
+
+// 测试棋盘压缩编码
+void SimpleTest::testBoardCodec() {
+    QRandomGenerator rng(2024);
+    const int cellCount = 512 * 512;
+    for (int percent : {0, 5, 50, 100}) {
+        QByteArray cells(cellCount, 0);
+        for (int i = 0; i < cellCount; ++i)
+            if (int(rng.bounded(100)) < percent) cells[i] = char(packBlock(rng.bounded(3), 1));
+        cells[cellCount / 2] = char(packBlock(1, 2)); // 一个激活的方块
+        QByteArray encoded = encodeBoard(cells);
+        QByteArray decoded;
+        QVERIFY(decodeBoard(encoded.constData(), encoded.size(), cellCount, decoded));
+        QCOMPARE(decoded, cells);
+        QVERIFY(!decodeBoard(encoded.constData(), encoded.size() - 1, cellCount, decoded));
+        if (percent <= 5) QVERIFY(encoded.size() * 10 < cellCount);
+        else QVERIFY(encoded.size() * 3 < cellCount);
+    }
+}
+
+// 测试无窗口重放
+void SimpleTest::testHeadlessReplay() {
+    Replay replay;
+    replay.mode = GameMode::Single;
+    replay.seed = 20240601;
+    const int keys[4] = {Qt::Key_D, Qt::Key_S, Qt::Key_D, Qt::Key_S};
+    for (int round = 0; round < 40; ++round) {
+        replay.events.append(ReplayEvent{quint32(round * 100), ReplayEventType::Key, keys[round % 4]});
+        if (round % 5 == 0)
+            replay.events.append(ReplayEvent{quint32(round * 100 + 50), ReplayEventType::Tick, int(ReplayTick::Progress)});
+    }
+    replay.events.append(ReplayEvent{4000, ReplayEventType::Tick, int(ReplayTick::Prop)});
+
+    // 直接在无窗口游戏上执行一遍，得到期望的结果
+    SimpleMode game(nullptr, nullptr, replay.seed, true);
+    for (const ReplayEvent& event : replay.events) game.applyReplayEvent(event);
+    replay.score1 = game.score;
+    replay.boardHash = boardHash(game.packedBoard());
+    QCOMPARE(game.timeLeft, game.maxTime - 8);
+
+    ReplayResult result = Replayer::run(replay);
+    QVERIFY(result.matched);
+
+    Replay other = replay;
+    other.seed = replay.seed + 1;
+    QVERIFY(!Replayer::run(other).matched);
+}
+
+// 测试关键帧跳转
+void SimpleTest::testReplayKeyframeSeek() {
+    SimpleMode game(nullptr, nullptr, 777, true);
+    game.recorder.start(GameMode::Single, game.seed);
+    const int keys[4] = {Qt::Key_D, Qt::Key_S, Qt::Key_A, Qt::Key_S};
+    for (int round = 0; round < 80; ++round) {
+        game.recorder.recordKey(keys[round % 4]);
+        game.handleKey(keys[round % 4]);
+        if (round % 2 == 0) {
+            game.recorder.recordTick(ReplayTick::Progress);
+            game.progress();
+        }
+    }
+    Replay replay = game.recorder.recorded();
+    game.recorder.cancel();
+    QCOMPARE(replay.keyframes.size(), 4);
+    // 录制太快，改用固定间隔的时间戳，关键帧时间跟随触发它的倒计时事件
+    for (int i = 0; i < replay.events.size(); ++i) replay.events[i].time = quint32(i * 100);
+    for (ReplayKeyframe& keyframe : replay.keyframes) keyframe.time = replay.events[keyframe.eventIndex - 1].time;
+    replay.score1 = game.score;
+    replay.boardHash = boardHash(game.packedBoard());
+
+    QTemporaryDir dir;
+    QString path = dir.filePath("test.qrpl");
+    QVERIFY(saveReplay(path, replay));
+    Replay loaded;
+    QVERIFY(loadReplay(path, loaded));
+    QCOMPARE(loaded.events.size(), replay.events.size());
+    QCOMPARE(loaded.keyframes.size(), replay.keyframes.size());
+    QCOMPARE(loaded.keyframes[1].state, replay.keyframes[1].state);
+    QVERIFY(Replayer::run(loaded).matched);
+
+    // 旧版本的录像无法复现，读取时直接拒绝并说明原因
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray bytes = file.readAll();
+    bytes[4] = 2;
+    file.seek(0);
+    file.write(bytes);
+    file.close();
+    QString error;
+    QVERIFY(!loadReplay(path, loaded, &error));
+    QVERIFY(error.contains("旧版"));
+
+    // 逐步推进的重放器不会恢复关键帧，作为对照
+    Replayer stepped(loaded);
+    Replayer seeking(loaded);
+    seeking.seek(replay.events.last().time);
+    for (quint32 time = 0; time <= replay.events.last().time; time += 700) {
+        stepped.seek(time);
+        seeking.seek(time);
+        QCOMPARE(seeking.simple->packedBoard(), stepped.simple->packedBoard());
+        QCOMPARE(seeking.simple->score, stepped.simple->score);
+        QCOMPARE(seeking.simple->timeLeft, stepped.simple->timeLeft);
+    }
+    seeking.seek(replay.events.last().time);
+    QCOMPARE(boardHash(seeking.simple->packedBoard()), replay.boardHash);
+}
+
+// 测试撤销/重做
+void SimpleTest::testUndoHistory() {
+    const int side = 512;
+    const uchar normal = packBlock(0, 1);
+    BoardVersion base(side, side, QByteArray(side * side, char(normal)));
+    BoardVersion version = base;
+    for (int k = 0; k < 1000; ++k) version = version.with(k % 100, (k * 7) % side, 0);
+    QCOMPARE(int(version.at(5, 35)), 0);
+    QCOMPARE(int(base.at(5, 35)), int(normal));
+    QVERIFY(!version.sharesRow(base, 5));
+    QVERIFY(version.sharesRow(base, 200));
+    QVERIFY(base.updated(base.cells()).sharesRow(base, 0));
+
+    SimpleMode* mode = createTestSimpleMode();
+    int layout[14][14] = {0};
+    layout[2][2] = layout[2][3] = 1;
+    layout[5][2] = layout[5][3] = 1; // 留一对，消除后游戏不结束
+    setupTestLayout(mode, layout);
+    for (int j : {2, 3}) {
+        mode->blocks[2][j]->setForm(0);
+        mode->blocks[5][j]->setForm(1);
+    }
+    mode->syncPackedCells();
+    mode->score = 0;
+    mode->history.reset(mode->undoStep());
+    mode->tryActivateBlock(2, 2);
+    mode->tryActivateBlock(3, 2);
+    QCOMPARE(mode->score, 2);
+    QCOMPARE(mode->blocks[2][2]->getState(), 0);
+    QCOMPARE(mode->history.size(), 2);
+
+    mode->undo();
+    QVERIFY(mode->practice);
+    QCOMPARE(mode->score, 0);
+    QCOMPARE(mode->blocks[2][2]->getState(), 1);
+    QCOMPARE(mode->blocks[2][3]->getState(), 1);
+    QCOMPARE(mode->blocks[5][2]->getState(), 1);
+
+    mode->redo();
+    QCOMPARE(mode->score, 2);
+    QCOMPARE(mode->blocks[2][2]->getState(), 0);
+    QCOMPARE(mode->blocks[2][3]->getState(), 0);
+    delete mode;
+}
+
+// 测试快速存档
+void SimpleTest::testQuickSlots() {
+    SimpleMode* mode = createTestSimpleMode();
+    int layout[14][14] = {0};
+    layout[2][2] = layout[2][3] = 1;
+    layout[5][2] = layout[5][3] = 1; // 留一对，消除后游戏不结束
+    setupTestLayout(mode, layout);
+    for (int j : {2, 3}) {
+        mode->blocks[2][j]->setForm(0);
+        mode->blocks[5][j]->setForm(1);
+    }
+    mode->syncPackedCells();
+    mode->score = 0;
+    QVERIFY(!mode->quickSlots.snapshot(0));
+    mode->tryActivateBlock(2, 2);
+    mode->quickSave(0);
+    // 快照直接保存压缩棋盘和标量状态
+    const GameSnapshot* saved = mode->quickSlots.snapshot(0);
+    QVERIFY(saved);
+    QCOMPARE(saved->cells, mode->packedBoard());
+    QCOMPARE(saved->player1, QPoint(mode->player->getXInMap(), mode->player->getYInMap()));
+    QCOMPARE(saved->active1, QPoint(2, 2));
+    mode->tryActivateBlock(3, 2);
+    QCOMPARE(mode->score, 2);
+    QCOMPARE(mode->blocks[2][2]->getState(), 0);
+    mode->scheduler->schedule(GameTimer::Prop, 50, 30000);
+
+    mode->quickLoad(0);
+    // 道具生成按快照中的剩余时间继续，不沿用读档前的安排
+    QVERIFY(mode->scheduler->remaining(GameTimer::Prop) > 20000);
+    QVERIFY(mode->scheduler->isScheduled(GameTimer::Progress));
+    QCOMPARE(mode->score, 0);
+    QCOMPARE(mode->blocks[2][2]->getState(), 2);
+    QCOMPARE(mode->blocks[2][3]->getState(), 1);
+    QCOMPARE(mode->activeBlock, mode->blocks[2][2]);
+    mode->quickLoad(1); // 空槽不改变局面
+    QCOMPARE(mode->activeBlock, mode->blocks[2][2]);
+    delete mode;
+}
+
+// 测试游戏调度器
+void SimpleTest::testGameScheduler() {
+    GameScheduler scheduler;
+    int ticks = 0;
+    connect(&scheduler, &GameScheduler::fired, [&ticks](GameTimer id) { if (id == GameTimer::Progress) ++ticks; });
+    scheduler.schedule(GameTimer::Progress, 20, 20);
+    scheduler.schedule(GameTimer::Effect, 10000);
+    QVERIFY(QTest::qWaitFor([&ticks]() { return ticks >= 3; }, 2000));
+
+    // 暂停期间游戏时钟停走，剩余时间和触发次数都不变
+    scheduler.pause();
+    const int pausedTicks = ticks;
+    const qint64 left = scheduler.remaining(GameTimer::Effect);
+    QTest::qWait(100);
+    QCOMPARE(ticks, pausedTicks);
+    QCOMPARE(scheduler.remaining(GameTimer::Effect), left);
+    scheduler.resume();
+    QVERIFY(QTest::qWaitFor([&ticks, pausedTicks]() { return ticks > pausedTicks; }, 2000));
+
+    // 保存后恢复到另一个调度器，剩余时间和周期保持
+    GameScheduler copy;
+    copy.restore(scheduler.save());
+    QVERIFY(copy.isScheduled(GameTimer::Progress));
+    QVERIFY(copy.remaining(GameTimer::Effect) <= left);
+    QVERIFY(copy.remaining(GameTimer::Effect) > left - 1000);
+    copy.cancel(GameTimer::Effect);
+    QVERIFY(!copy.isScheduled(GameTimer::Effect));
+    QCOMPARE(copy.remaining(GameTimer::Effect), qint64(-1));
+}
+
+// 测试固定步长模拟
+void SimpleTest::testSimulationStep() {
+    SimpleMode game(nullptr, nullptr, 99, true);
+    int layout[14][14] = {0};
+    setupTestLayout(&game, layout);
+    game.player->setXInMap(2);
+    game.player->setYInMap(2);
+    auto postKey = [&game](int key) { game.simulation.postKey(key, 0); game.scheduleStep(); };
+
+    // 输入排队到下一个步边界才执行，同一步内按到达顺序执行
+    postKey(Qt::Key_D);
+    postKey(Qt::Key_S);
+    QCOMPARE(QPoint(game.player->getXInMap(), game.player->getYInMap()), QPoint(2, 2));
+    game.scheduler->advance(simulationStep - 1);
+    QCOMPARE(QPoint(game.player->getXInMap(), game.player->getYInMap()), QPoint(2, 2));
+    game.scheduler->advance(1);
+    QCOMPARE(QPoint(game.player->getXInMap(), game.player->getYInMap()), QPoint(3, 3));
+    QCOMPARE(game.simulation.steps(), qint64(1));
+
+    // 暂停时手动时钟不走
+    postKey(Qt::Key_D);
+    game.scheduler->pause();
+    game.scheduler->advance(1000);
+    QCOMPARE(game.player->getXInMap(), 3);
+    game.scheduler->resume();
+    game.scheduler->advance(simulationStep);
+    QCOMPARE(game.player->getXInMap(), 4);
+
+    // 快进一分钟游戏时间，周期事件不等待地逐次执行
+    game.scheduler->schedule(GameTimer::Progress, 1000, 1000);
+    game.scheduler->advance(60000);
+    QCOMPARE(game.timeLeft, game.maxTime - 60);
+}
+
+// 测试双人模式的按键重复
+void SimpleTest::testDuoKeyRepeat() {
+    // 每个玩家独立计时，满延迟后按间隔重复，同一步内两个玩家都被采样
+    KeyRepeat keys(200, 60);
+    keys.press(Qt::Key_D, 1, 0);
+    keys.press(Qt::Key_Left, 2, 0);
+    QVERIFY(keys.sample(100).isEmpty());
+    QCOMPARE(keys.sample(200), QVector<int>({Qt::Key_D, Qt::Key_Left}));
+    QVERIFY(keys.sample(220).isEmpty());
+    QCOMPARE(keys.sample(260), QVector<int>({Qt::Key_D, Qt::Key_Left}));
+    // 同一玩家按住两个方向键时以最后按下的为准，松开后回到先按下的键
+    keys.press(Qt::Key_S, 1, 270);
+    keys.release(Qt::Key_Left, 270);
+    QVERIFY(keys.sample(320).isEmpty());
+    QCOMPARE(keys.sample(470), QVector<int>({Qt::Key_S}));
+    keys.release(Qt::Key_S, 480);
+    QVERIFY(keys.sample(600).isEmpty());
+    QCOMPARE(keys.sample(680), QVector<int>({Qt::Key_D}));
+    keys.releaseAll();
+    QVERIFY(!keys.isHeld());
+
+    // 两个玩家同时按住方向键，移动的步数相同
+    DuoMode game(nullptr, nullptr, 5, true);
+    int layout[14][14] = {0};
+    setupTestLayout(&game, layout);
+    game.keys = KeyRepeat(200, 60);
+    game.player1->setXInMap(2);
+    game.player1->setYInMap(2);
+    game.player2->setXInMap(2);
+    game.player2->setYInMap(6);
+    for (int key : {Qt::Key_D, Qt::Key_Right}) {
+        game.keys.press(key, key == Qt::Key_D ? 1 : 2, game.scheduler->now());
+        game.simulation.postKey(key, 0);
+        game.scheduleStep();
+    }
+    game.scheduler->advance(400); // 按下时移动一次，之后在200、260、320、380毫秒重复
+    QCOMPARE(game.player1->getXInMap(), 7);
+    QCOMPARE(game.player2->getXInMap(), 7);
+    game.keys.releaseAll();
+    game.scheduler->advance(400);
+    QCOMPARE(game.player1->getXInMap(), 7);
+}
+
+// 测试对局状态变化
+void SimpleTest::testGameEvents() {
+    SimpleMode game(nullptr, nullptr, 11, true);
+    int layout[14][14] = {0};
+    for (int row : {2, 5, 8}) layout[row][2] = layout[row][3] = 1;
+    setupTestLayout(&game, layout);
+    for (int row : {2, 5, 8})
+        for (int col : {2, 3}) game.blocks[row][col]->setForm(row / 3);
+    game.syncPackedCells();
+    game.journal.takePending();
+    SaveData base = game.getSaveData();
+    QVector<GameEvent> events;
+    connect(&game, &SimpleMode::gameEvent, [&events](const GameEvent& event) { events.append(event); });
+
+    // 消除一对：先发出分数变化，再发出消除
+    game.effects.apply(ItemType::Hint, 0, -1);
+    game.hintBlock1 = QPoint(2, 5);
+    game.hintBlock2 = QPoint(3, 5);
+    game.tryActivateBlock(2, 2);
+    game.tryActivateBlock(3, 2);
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events[0].type, GameEventType::ScoreChanged);
+    QCOMPARE(events[0].value, 2);
+    QCOMPARE(events[1].type, GameEventType::CellsCleared);
+    QCOMPARE(events[1].a, QPoint(2, 2));
+    QCOMPARE(events[1].b, QPoint(3, 2));
+    QCOMPARE(game.hintBlock1, QPoint(2, 5)); // 与Hint无关的消除不重新查找
+
+    // 消除Hint方块对后重新查找
+    game.tryActivateBlock(2, 5);
+    game.tryActivateBlock(3, 5);
+    QCOMPARE(game.hintBlock1, QPoint(2, 8));
+    QCOMPARE(game.hintBlock2, QPoint(3, 8));
+
+    // 日志只通过订阅得到消除记录，重放后与游戏内状态一致
+    QVERIFY(MoveJournal::replay(game.journal.takePending(), base));
+    QCOMPARE(base.cells, game.packedBoard());
+    QCOMPARE(base.score1, game.score);
+
+    // 玩家移动
+    game.player->setXInMap(0);
+    game.player->setYInMap(0);
+    game.handleMove(1, 0);
+    QCOMPARE(events.last().type, GameEventType::PlayerMoved);
+    QCOMPARE(events.last().playerId, 1);
+    QCOMPARE(events.last().a, QPoint(1, 0));
+}
+
+// 测试空闲格集合
+// 直接操作集合，并检查消除、生成道具、拾取道具后游戏内的集合与整盘扫描结果一致
+void SimpleTest::testFreeCellSet() {
+    FreeCellSet set;
+    set.reset(3, 4);
+    QRandomGenerator rng(7);
+    QCOMPARE(set.draw(rng), QPoint(-1, -1));
+    for (int x = 0; x < 4; ++x) QVERIFY(set.insert(QPoint(x, 1)));
+    QVERIFY(!set.insert(QPoint(2, 1)));  // 重复加入
+    QVERIFY(!set.insert(QPoint(4, 0)));  // 超出地图
+    QCOMPARE(set.size(), 4);
+
+    // 移除中间的格子后，末尾元素补位，下标表保持一致
+    QVERIFY(set.remove(QPoint(1, 1)));
+    QVERIFY(!set.remove(QPoint(1, 1)));
+    QCOMPARE(set.size(), 3);
+    QVERIFY(!set.contains(QPoint(1, 1)));
+    for (int i = 0; i < set.size(); ++i) QVERIFY(set.contains(set.at(i)));
+    QVERIFY(set.remove(QPoint(3, 1)));
+    QVERIFY(set.insert(QPoint(1, 1)));
+    for (int i = 0; i < set.size(); ++i) QVERIFY(set.contains(set.at(i)));
+    for (int i = 0; i < 100; ++i) QVERIFY(set.contains(set.draw(rng)));
+
+    // 游戏内的集合随状态变化增量维护
+    SimpleMode game(nullptr, nullptr, 11, true);
+    int layout[14][14] = {0};
+    layout[2][2] = layout[2][3] = 1;
+    layout[6][6] = layout[7][7] = 1;
+    setupTestLayout(&game, layout);
+    game.blocks[2][2]->setForm(0);
+    game.blocks[2][3]->setForm(0);
+    game.syncPackedCells();
+    game.rebuildFreeCells();
+    auto matchesScan = [&game]() {
+        int expected = 0;
+        for (int i = 0; i < game.rows; ++i)
+            for (int j = 0; j < game.cols; ++j) {
+                bool free = game.blocks[i][j] && game.blocks[i][j]->getState() == 0;
+                if (game.props.itemAt(QPoint(j, i))) free = false;
+                if (free != game.freeCells.contains(QPoint(j, i))) return false;
+                if (free) ++expected;
+            }
+        return expected == game.freeCells.size();
+    };
+    QVERIFY(matchesScan());
+    QVERIFY(!game.freeCells.contains(QPoint(2, 2)));
+
+    game.tryActivateBlock(2, 2);
+    game.tryActivateBlock(3, 2);
+    QVERIFY(game.freeCells.contains(QPoint(2, 2)));
+    QVERIFY(game.freeCells.contains(QPoint(3, 2)));
+    QVERIFY(matchesScan());
+
+    game.generateProp();
+    QPoint cell = game.props.at(game.props.size() - 1).getMapPos();
+    QVERIFY(!game.freeCells.contains(cell));
+    QVERIFY(matchesScan());
+
+    // 拾取一个不会改动棋盘的道具后，该格重新空闲
+    game.props.itemAt(cell)->setType(ItemType::AddTime);
+    game.player->setXInMap(cell.x());
+    game.player->setYInMap(cell.y());
+    game.checkPropCollision();
+    QVERIFY(!game.props.itemAt(cell));
+    QVERIFY(game.freeCells.contains(cell));
+    QVERIFY(matchesScan());
+}
+
+// 测试道具池
+// 检查句柄失效、按格查找，以及反复生成和拾取后槽位数量不增长
+void SimpleTest::testPropPool() {
+    PropPool pool;
+    pool.reset(4, 5);
+    PropHandle a = pool.add(ItemType::AddTime, QPoint(1, 1), QRectF(), QPixmap());
+    PropHandle b = pool.add(ItemType::Hint, QPoint(3, 2), QRectF(), QPixmap());
+    QVERIFY(!a.isNull() && !b.isNull());
+    QVERIFY(pool.add(ItemType::Freeze, QPoint(1, 1), QRectF(), QPixmap()).isNull()); // 格子已有道具
+    QVERIFY(pool.add(ItemType::Freeze, QPoint(5, 0), QRectF(), QPixmap()).isNull()); // 超出地图
+    QCOMPARE(pool.size(), 2);
+    QVERIFY(pool.handleAt(QPoint(1, 1)) == a);
+    QCOMPARE(pool.itemAt(QPoint(3, 2))->getType(), ItemType::Hint);
+    QVERIFY(!pool.itemAt(QPoint(0, 0)));
+
+    // 回收前面的道具后，末尾的道具补位，句柄仍然有效
+    QVERIFY(pool.remove(a));
+    QVERIFY(!pool.remove(a));
+    QVERIFY(!pool.get(a));
+    QVERIFY(!pool.itemAt(QPoint(1, 1)));
+    QCOMPARE(pool.get(b)->getMapPos(), QPoint(3, 2));
+
+    // 复用的槽位代数不同，旧句柄不会指向新道具
+    PropHandle c = pool.add(ItemType::Shuffle, QPoint(0, 3), QRectF(), QPixmap());
+    QCOMPARE(c.slot, a.slot);
+    QVERIFY(c != a);
+    QVERIFY(!pool.get(a));
+    QCOMPARE(pool.get(c)->getType(), ItemType::Shuffle);
+
+    // 清空后所有旧句柄失效
+    pool.clear();
+    QVERIFY(pool.isEmpty());
+    QVERIFY(!pool.get(b) && !pool.get(c));
+    QVERIFY(!pool.itemAt(QPoint(3, 2)));
+
+    // 游戏中反复生成和拾取道具，槽位数量只取决于同时存在的道具数量
+    SimpleMode game(nullptr, nullptr, 5, true);
+    int layout[14][14] = {0};
+    setupTestLayout(&game, layout);
+    game.props.clear();
+    game.rebuildFreeCells();
+    for (int round = 0; round < 200; ++round) {
+        game.generateProp();
+        QPoint cell = game.props.at(0).getMapPos();
+        game.props.itemAt(cell)->setType(ItemType::AddTime);
+        game.player->setXInMap(cell.x());
+        game.player->setYInMap(cell.y());
+        game.checkPropCollision();
+        QVERIFY(game.props.isEmpty());
+    }
+    QCOMPARE(game.props.slotCount(), 1);
+}
+
+// 测试道具效果系统
+// 检查登记表、同类效果叠加、保存恢复，以及双人模式中由调度器结束的冻结效果
+void SimpleTest::testEffectSystem() {
+    // 登记表决定作用对象和重放的结束事件
+    const EffectSpec* freeze = effectSpec(ItemType::Freeze);
+    QVERIFY(freeze);
+    QCOMPARE(freeze->targetOf(1), 2);
+    QCOMPARE(effectSpec(ItemType::Hint)->targetOf(2), 0);
+    QCOMPARE(effectSpec(ItemType::Shuffle)->target, EffectTarget::Instant);
+    ItemType type;
+    int playerId;
+    QVERIFY(effectForTick(ReplayTick::Freeze2End, type, playerId));
+    QCOMPARE(type, ItemType::Freeze);
+    QCOMPARE(playerId, 2);
+    QVERIFY(!effectForTick(ReplayTick::Prop, type, playerId));
+
+    // 叠加的记录全部到期后效果才结束
+    EffectSystem effects;
+    QVERIFY(effects.apply(ItemType::Dizzy, 1, 100));
+    QVERIFY(!effects.apply(ItemType::Dizzy, 1, 200));
+    QVERIFY(effects.apply(ItemType::Hint, 0, 150));
+    QCOMPARE(effects.stacks(ItemType::Dizzy, 1), 2);
+    QCOMPARE(effects.nextExpiry(), qint64(100));
+    QVERIFY(effects.expire(120).isEmpty());
+    QVERIFY(effects.isActive(ItemType::Dizzy, 1));
+    QCOMPARE(effects.keyframeFlags(), quint32(KeyframeDizzy1 | KeyframeHint));
+
+    // 保存为剩余时间，恢复后从新的时刻继续计时；只有标志的效果按完整时长计时
+    QVector<StatusEffect> saved = effects.save(130);
+    effects.restore(saved, KeyframeFreeze2, 1000, true);
+    QCOMPARE(effects.nextExpiry(), qint64(1020));
+    QVERIFY(effects.isActive(ItemType::Freeze, 2));
+    QVector<StatusEffect> ended = effects.expire(1070);
+    QCOMPARE(ended.size(), 2);
+    QCOMPARE(ended[0].type, ItemType::Hint);
+    QCOMPARE(ended[1].type, ItemType::Dizzy);
+    QCOMPARE(effects.nextExpiry(), qint64(1000 + freeze->duration));
+
+    // 双人模式中冻结叠加，调度器在最后一条记录到期时结束并只发出一次结束
+    DuoMode game(nullptr, nullptr, 5, true);
+    int layout[14][14] = {0};
+    setupTestLayout(&game, layout);
+    game.player2->setXInMap(2);
+    game.player2->setYInMap(6);
+    int endedCount = 0;
+    connect(&game, &DuoMode::gameEvent, [&endedCount](const GameEvent& event) {
+        if (event.type == GameEventType::EffectEnded) ++endedCount;
+    });
+    game.effects.apply(ItemType::Freeze, 2, game.scheduler->now() + 3000);
+    game.effects.apply(ItemType::Freeze, 2, game.scheduler->now() + 5000);
+    game.armEffects();
+    game.handleMove(1, 0, 2);
+    QCOMPARE(game.player2->getXInMap(), 2);
+    game.scheduler->advance(4000);
+    QVERIFY(game.effects.isActive(ItemType::Freeze, 2));
+    QCOMPARE(endedCount, 0);
+    game.scheduler->advance(1000);
+    QVERIFY(!game.effects.isActive(ItemType::Freeze, 2));
+    QCOMPARE(endedCount, 1);
+    QVERIFY(!game.scheduler->isScheduled(GameTimer::Effect));
+    game.handleMove(1, 0, 2);
+    QCOMPARE(game.player2->getXInMap(), 3);
+}
+
+// 测试后台Hint查找
+// 检查压缩棋盘上的查找结果、取消、过期结果的丢弃，以及Hint道具直接读取预先算好的结果
+void SimpleTest::testHintSolver() {
+    SimpleMode* mode = createTestSimpleMode();
+    int layout[14][14] = {0};
+    layout[3][3] = layout[3][6] = 1;   // 同一行，中间为空，可以直线连接
+    layout[5][2] = layout[8][9] = 1;   // 另一种形状
+    setupTestLayout(mode, layout);
+    mode->blocks[3][3]->setForm(1);
+    mode->blocks[3][6]->setForm(1);
+    mode->blocks[5][2]->setForm(2);
+    mode->blocks[8][9]->setForm(2);
+    mode->syncPackedCells();
+    QPoint a, b;
+    QVERIFY(findLinkPair(mode->packedBoard(), mode->rows, mode->cols, a, b));
+    QCOMPARE(a, QPoint(3, 3));
+    QCOMPARE(b, QPoint(6, 3));
+    QVERIFY(mode->canLink(a.x(), a.y(), b.x(), b.y()));
+    QVERIFY(!findLinkPair(mode->packedBoard(), mode->rows, mode->cols, a, b, []() { return true; }));
+    QCOMPARE(a, QPoint(-1, -1));
+
+    // 连续提交两次，只送回最后一次提交的结果
+    HintSolver solver;
+    int solvedCount = 0;
+    connect(&solver, &HintSolver::solved, [&solvedCount]() { ++solvedCount; });
+    QByteArray before = mode->packedBoard();
+    mode->blocks[3][3]->setState(0);
+    mode->blocks[3][6]->setState(0);
+    mode->syncPackedCells();
+    solver.submit(before, mode->rows, mode->cols);
+    solver.submit(mode->packedBoard(), mode->rows, mode->cols);
+    QVERIFY(!solver.isReady());
+    QVERIFY(QTest::qWaitFor([&solver]() { return solver.isReady(); }, 2000));
+    QTest::qWait(50);
+    QCOMPARE(solvedCount, 1);
+    QCOMPARE(solver.first(), QPoint(2, 5));
+    QCOMPARE(solver.second(), QPoint(9, 8));
+
+    // 有窗口的游戏在后台预先查找，Hint道具生效时立即显示
+    mode->updateHint();
+    QVERIFY(QTest::qWaitFor([mode]() { return mode->hintSolver.isReady(); }, 2000));
+    mode->startEffect(ItemType::Hint, 1);
+    QCOMPARE(mode->hintBlock1, QPoint(2, 5));
+    QCOMPARE(mode->hintBlock2, QPoint(9, 8));
+
+    // 没有提交过时，Hint道具生效立即提交，送回后显示
+    mode->endEffect(ItemType::Hint, 0);
+    mode->hintBlock1 = mode->hintBlock2 = QPoint(-1, -1);
+    mode->hintSolver.cancel();
+    QVERIFY(!mode->hintSolver.isPending());
+    mode->startEffect(ItemType::Hint, 1);
+    QVERIFY(mode->hintSolver.isPending());
+    QVERIFY(QTest::qWaitFor([mode]() { return mode->hintBlock1 == QPoint(2, 5); }, 2000));
+    delete mode;
+}
+
+// 测试死局检测和自动洗牌
+void SimpleTest::testDeadBoard() {
+    SimpleMode* mode = createTestSimpleMode();
+    int layout[14][14] = {0};
+    layout[3][3] = layout[6][8] = 1;   // 两个方块形状不同，没有可消除对
+    setupTestLayout(mode, layout);
+    mode->blocks[3][3]->setForm(1);
+    mode->blocks[6][8]->setForm(2);
+    mode->syncPackedCells();
+    QVERIFY(!mode->boardCleared());
+    QCOMPARE(mode->deadBoardOutcome(), ReplayTick::DeadShuffle);
+
+    // 后台查找发现死局后自动洗牌，洗牌后仍是死局，达到上限时结束对局
+    mode->updateHint();
+    QVERIFY(QTest::qWaitFor([mode]() { return mode->finished; }, 5000));
+    QCOMPARE(mode->deadShuffles, deadBoardShuffleLimit);
+    // 结束弹窗不阻塞，结束后定时事件全部停止，读档也不再生效
+    QVERIFY(!mode->scheduler->isScheduled(GameTimer::Prop));
+    QVERIFY(!mode->scheduler->isScheduled(GameTimer::Autosave));
+    mode->quickSave(0);
+    mode->quickLoad(0);
+    QVERIFY(mode->finished);
+    delete mode;
+
+    // 策略为直接结束时不洗牌
+    mode = createTestSimpleMode();
+    setupTestLayout(mode, layout);
+    mode->blocks[3][3]->setForm(1);
+    mode->blocks[6][8]->setForm(2);
+    mode->syncPackedCells();
+    mode->deadBoardPolicy = DeadBoardPolicy::End;
+    QCOMPARE(mode->deadBoardOutcome(), ReplayTick::DeadEnd);
+    mode->updateHint();
+    QVERIFY(QTest::qWaitFor([mode]() { return mode->finished; }, 2000));
+    QCOMPARE(mode->deadShuffles, 0);
+    delete mode;
+
+    // 重放时按录制的处理方式执行，与策略无关
+    SimpleMode game(nullptr, nullptr, 1, true);
+    game.deadBoardPolicy = DeadBoardPolicy::End;
+    const QByteArray before = game.packedBoard();
+    game.applyReplayEvent(ReplayEvent{0, ReplayEventType::Tick, int(ReplayTick::DeadShuffle)});
+    QVERIFY(!game.finished);
+    QCOMPARE(game.deadShuffles, 1);
+    QVERIFY(game.packedBoard() != before);
+    game.applyReplayEvent(ReplayEvent{0, ReplayEventType::Tick, int(ReplayTick::DeadEnd)});
+    QVERIFY(game.finished);
+}
+
+// 测试开局棋盘流水线
+void SimpleTest::testBoardPipeline() {
+    // 预先发好的棋盘与按种子当场发牌的开局完全一致，重放只需要种子
+    const PreparedBoard dealt = dealBoard(4242, 14, 14, 3);
+    SimpleMode fresh(nullptr, nullptr, 4242, true);
+    SimpleMode prepared(nullptr, nullptr, 4242, true, &dealt);
+    QCOMPARE(prepared.packedBoard(), fresh.packedBoard());
+    QCOMPARE(prepared.keyframeSeed, fresh.keyframeSeed);
+    QCOMPARE(prepared.packedBoard()[3 * 14 + 5], dealt.cells[3 * 14 + 5]);
+
+    // 两对交叉放置时互相挡住，消不完
+    QByteArray cells(6 * 6, char(packBlock(-1, 0)));
+    cells[2 * 6 + 2] = cells[3 * 6 + 3] = char(packBlock(0, 1));
+    cells[2 * 6 + 3] = cells[3 * 6 + 2] = char(packBlock(1, 1));
+    QVERIFY(!isBoardSolvable(cells, 6, 6));
+    cells[3 * 6 + 2] = char(packBlock(0, 1));
+    cells[3 * 6 + 3] = char(packBlock(1, 1));
+    QVERIFY(isBoardSolvable(cells, 6, 6));
+
+    // 后台填满队列，取出后自动补足
+    BoardPipeline pipeline(14, 14, 3, 2);
+    QVERIFY(QTest::qWaitFor([&pipeline]() { return pipeline.size() == 2; }, 5000));
+    PreparedBoard board = pipeline.take();
+    QVERIFY(board.matches(board.seed, 14, 14, 3));
+    QVERIFY(isBoardSolvable(board.cells, 14, 14));
+    QCOMPARE(board.cells, dealBoard(board.seed, 14, 14, 3).cells);
+    QCOMPARE(pipeline.size(), 1);
+    QVERIFY(QTest::qWaitFor([&pipeline]() { return pipeline.size() == 2; }, 5000));
+}
+
+// 测试丢弃自动存档
+void SimpleTest::testAutoSaverDiscard() {
+    SimpleMode game(nullptr, nullptr, 5, true);
+    const SaveData data = game.getSaveData();
+    QTemporaryDir dir;
+    const QString path = dir.filePath("autosave.qsav");
+    {
+        AutoSaver saver(path);
+        saver.submit(data);
+        saver.append(QByteArray("x"));
+        saver.discard();
+        saver.submit(data); // 丢弃后的提交被忽略
+    }
+    QVERIFY(!QFile::exists(path));
+    QVERIFY(!QFile::exists(path + ".journal"));
+
+    // 丢弃之前写好的存档也会被删除
+    {
+        AutoSaver saver(path);
+        saver.submit(data);
+    }
+    QVERIFY(QFile::exists(path));
+    {
+        AutoSaver saver(path);
+        saver.discard();
+    }
+    QVERIFY(!QFile::exists(path));
+
+    QVERIFY(AutoSaver::pathFor(GameMode::Single).isEmpty());
+    AutoSaver disabled{QString()};
+    disabled.submit(data);
+    disabled.discard();
+}
+
+// 测试存档浏览对话框
+void SimpleTest::testSaveBrowser() {
+    SaveLibrary* library = SaveLibrary::instance();
+    SimpleMode game(nullptr, nullptr, 8, true);
+    const SaveData data = game.getSaveData();
+    const QString first = SaveLibrary::directory() + "/browser-a.qsav";
+    const QString second = SaveLibrary::directory() + "/browser-b.qsav";
+    QVERIFY(library->save(first, data));
+    SaveBrowser browser;
+    QVERIFY(browser.list->count() > 0);
+    QListWidgetItem* firstItem = browser.list->item(0);
+    QCOMPARE(firstItem->data(Qt::UserRole).toString(), QString("browser-a.qsav"));
+
+    // 保存新存档只插入这一项，已有的列表项原样保留
+    QVERIFY(library->save(second, data));
+    QCOMPARE(browser.list->item(0)->data(Qt::UserRole).toString(), QString("browser-b.qsav"));
+    QCOMPARE(browser.list->item(1), firstItem);
+    QCOMPARE(browser.list->currentRow(), 0);
+
+    // 重新扫描后删除的存档从列表中移除，其余列表项继续复用
+    QVERIFY(QFile::remove(second));
+    library->refresh();
+    QVERIFY(QTest::qWaitFor([&browser, firstItem]() { return browser.list->count() > 0 && browser.list->item(0) == firstItem; }, 5000));
+    for (int i = 0; i < browser.list->count(); ++i)
+        QVERIFY(browser.list->item(i)->data(Qt::UserRole).toString() != "browser-b.qsav");
+    QFile::remove(first);
+    library->refresh();
+}
+
+// 测试分块并行渲染
+void SimpleTest::testTileRenderer() {
+    const int rows = 20, cols = 20, cellSize = 10, margin = 1;
+    QVector<QImage> sprites;
+    for (int i = 0; i < 6; ++i) {
+        QImage sprite(cellSize - 2 * margin, cellSize - 2 * margin, QImage::Format_RGB32);
+        sprite.fill(qRgb(40 * i, 255 - 40 * i, 100));
+        sprites.append(sprite);
+    }
+    TileRenderer renderer;
+    renderer.setSprites(cellSize, margin, 1.0, sprites);
+    QByteArray cells(rows * cols, char(packBlock(-1, 0)));
+    cells[1 * cols + 1] = char(packBlock(0, 1));
+    cells[18 * cols + 18] = char(packBlock(1, 2));
+    renderer.setBoard(rows, cols, cells);
+    QCOMPARE(renderer.tiles.size(), 4); // 20x20的棋盘切成16格、4格宽的2x2个分块
+    renderer.render();
+    for (const auto& tile : renderer.tiles) QVERIFY(!tile.dirty);
+
+    QImage canvas(cols * cellSize, rows * cellSize, QImage::Format_RGB32);
+    canvas.fill(qRgb(255, 255, 255));
+    {
+        QPainter painter(&canvas);
+        renderer.composite(painter, QPoint(0, 0));
+    }
+    QCOMPARE(canvas.pixel(1 * cellSize + cellSize / 2, 1 * cellSize + cellSize / 2), qRgb(0, 255, 100));
+    QCOMPARE(canvas.pixel(18 * cellSize + cellSize / 2, 18 * cellSize + cellSize / 2), qRgb(120, 135, 100));
+    QCOMPARE(canvas.pixel(5 * cellSize + cellSize / 2, 5 * cellSize + cellSize / 2), qRgb(255, 255, 255));
+
+    // 内容不变时不重绘，改动一格只重绘所在的分块
+    renderer.setBoard(rows, cols, cells);
+    for (const auto& tile : renderer.tiles) QVERIFY(!tile.dirty);
+    cells[18 * cols + 18] = char(packBlock(-1, 0));
+    renderer.setBoard(rows, cols, cells);
+    int dirty = 0;
+    for (const auto& tile : renderer.tiles) {
+        if (tile.dirty) {
+            ++dirty;
+            QVERIFY(tile.cells.contains(18, 18));
+        }
+    }
+    QCOMPARE(dirty, 1);
+}
+
 // QTEST_MAIN(SimpleTest)
@@ -4,12 +4,17 @@
 #include <QTest>
 #include "simplemode.h"
 #include "duomode.h"
+#include "gamescheduler.h"
 
 class SimpleTest : public QObject
 {
     Q_OBJECT
 
 private slots:
+    // 所有测试开始前执行
+    // 打开QStandardPaths的测试模式，自动存档、重放等文件不写入用户的应用数据目录
+    void initTestCase();
+
     // 测试单人模式的直线连接判定
     // 测试canLinkInLine函数的各种情况：
     // 1. 水平直线连接（相邻和非相邻）
@@ -53,6 +58,110 @@ private slots:
     // 测试双人模式中canLink函数的正确性
     void testDuoModeCanLink();
 
+    // 测试单人模式的输入延迟
+    // 在显示的窗口上用QTest::keyClick反复注入移动、激活、消除操作
+    // 每个键执行完再发下一个，延迟包含最多一个模拟步的排队时间
+    // 输出每种动作的 p50/p95/p99 延迟，并检查 p95 不超过100毫秒
+    void testSimpleModeInputLatency();
+
+    // 测试二进制存档格式
+    // 1. 编码后再解码，所有字段保持一致
+    // 2. 截断或篡改任意字节后解码失败
+    void testBinarySaveFormat();
+
+    // 测试对局日志重放
+    // 在快照之后洗牌、移动玩家，重放日志得到的状态应与游戏内状态一致
+    void testJournalReplay();
+
+    // 测试棋盘压缩编码
+    // 稀疏和稠密棋盘编码后再解码保持一致，稀疏大棋盘至少压缩到十分之一
+    void testBoardCodec();
+
+    // 测试无窗口重放
+    // 同一种子和事件序列重放得到相同的分数和棋盘，换一个种子则校验失败
+    void testHeadlessReplay();
+
+    // 测试关键帧跳转
+    // 录制带关键帧的重放并读写文件，从关键帧跳转与逐步推进得到相同的状态，旧版本的录像读取时被拒绝
+    void testReplayKeyframeSeek();
+
+    // 测试撤销/重做
+    // 1. 修改棋盘版本只复制被修改的行，其余行与旧版本共享
+    // 2. 消除后撤销恢复方块和分数，重做再次消除
+    void testUndoHistory();
+
+    // 测试快速存档
+    // 1. 快照直接保存压缩棋盘、玩家位置和激活的方块
+    // 2. 快速存档后消除一对方块，快速读档恢复方块、分数和激活的方块
+    // 3. 读档后道具生成等定时事件从快照中的剩余时间继续
+    void testQuickSlots();
+
+    // 测试游戏调度器
+    // 1. 周期事件按周期触发，暂停期间不触发且剩余时间不变
+    // 2. 保存后恢复，各定时事件保留剩余时间
+    void testGameScheduler();
+
+    // 测试固定步长模拟
+    // 1. 输入排队到下一个步边界才执行，同一步内按到达顺序执行
+    // 2. 无窗口游戏用手动时钟快进，暂停时时钟不走
+    void testSimulationStep();
+
+    // 测试双人模式的按键重复
+    // 1. 按住方向键满延迟后按间隔重复，两个玩家独立计时
+    // 2. 两个玩家同时按住方向键，每一步都被采样，移动的步数相同
+    void testDuoKeyRepeat();
+
+    // 测试对局状态变化
+    // 1. 消除、移动时按顺序发出状态变化
+    // 2. 只有Hint方块对被消除时才重新查找Hint
+    // 3. 自动存档日志通过订阅得到记录，重放后与游戏内状态一致
+    void testGameEvents();
+
+    // 测试空闲格集合
+    // 1. 加入、移除后下标表与数组一致，随机抽取只返回集合中的格子
+    // 2. 消除、生成道具、拾取道具后，游戏内的集合与整盘扫描结果一致
+    void testFreeCellSet();
+
+    // 测试道具池
+    // 1. 回收后旧句柄失效，复用的槽位不会被旧句柄访问，按格查找与放置一致
+    // 2. 反复生成和拾取道具后，已分配的槽位数量不增长
+    void testPropPool();
+
+    // 测试道具效果系统
+    // 1. 登记表决定作用对象和重放的结束事件，同类效果叠加后最后一条到期才结束
+    // 2. 保存恢复保留剩余时间，双人模式中冻结由调度器按到期时间结束
+    void testEffectSystem();
+
+    // 测试后台Hint查找
+    // 1. 压缩棋盘上的查找结果与游戏内判定一致，取消后立即放弃
+    // 2. 连续提交时只送回最后一次的结果，Hint道具生效时直接读取预先算好的结果，没有提交过时立即提交
+    void testHintSolver();
+
+    // 测试死局处理
+    // 1. 后台查找发现死局后自动洗牌，连续洗牌达到上限时结束对局，结束后定时事件和读档都停止
+    // 2. 策略为直接结束时不洗牌，重放按录制的处理方式执行
+    void testDeadBoard();
+
+    // 测试开局棋盘流水线
+    // 1. 预先发好的棋盘与按种子当场发牌的开局一致
+    // 2. 只保留能消完的棋盘，取出后后台自动补足队列
+    void testBoardPipeline();
+
+    // 测试丢弃自动存档
+    // 1. 丢弃立即返回，排在写入之后删除文件，之后的提交被忽略
+    // 2. 路径为空时不写任何文件，测试模式下游戏窗口的自动存档路径为空
+    void testAutoSaverDiscard();
+
+    // 测试存档浏览对话框
+    // 1. 保存存档时只插入或移动这一项，已有的列表项和缩略图原样保留
+    // 2. 重新扫描后删除的存档从列表中移除
+    void testSaveBrowser();
+
+    // 测试分块并行渲染
+    // 1. 合成结果与按格子直接绘制的位置一致，空格子保持透明
+    // 2. 只改动一格时只有所在的分块需要重绘
+    void testTileRenderer();
+
 private:
     // 创建测试用的SimpleMode对象
     // 返回配置好的SimpleMode对象指针
@@ -0,0 +1,29 @@
+#include "simulationloop.h"
+
+// 加入一个按键输入
+void SimulationLoop::postKey(int key, qint64 stamp)
+{
+    queue.append(QueuedInput{ReplayEventType::Key, key, stamp});
+}
+
+// 加入一个点击输入
+// 坐标按ReplayEvent的方式打包，执行和录制时不需要再转换
+void SimulationLoop::postClick(const QPoint& cell, qint64 stamp)
+{
+    queue.append(QueuedInput{ReplayEventType::Click, (cell.y() << 16) | (cell.x() & 0xFFFF), stamp});
+}
+
+// 取出本步要执行的全部输入
+QVector<QueuedInput> SimulationLoop::take()
+{
+    QVector<QueuedInput> inputs;
+    inputs.swap(queue);
+    ++stepCount;
+    return inputs;
+}
+
+// 距下一个步边界的时间
+qint64 SimulationLoop::delayToNextStep(qint64 now)
+{
+    return simulationStep - now % simulationStep;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <QPoint>
+#include <QVector>
+#include "replay.h"
+
+const int simulationStep = 20; // 模拟步长（毫秒），游戏逻辑每秒最多推进50步
+
+// 排队等待模拟的输入
+struct QueuedInput {
+    ReplayEventType type;  // 按键或点击
+    int value;             // 按键的Qt::Key，或点击格子打包后的坐标（与ReplayEvent相同）
+    qint64 stamp;          // 收到输入的时间（纳秒，延迟探针时钟），用于统计输入到绘制的延迟
+
+    // 获取点击的地图坐标
+    QPoint cell() const { return QPoint(qint16(value & 0xFFFF), qint16(value >> 16)); }
+};
+
+// 固定步长模拟循环
+// 键盘和鼠标事件只把输入放入队列，游戏逻辑在对齐到simulationStep的步上按到达顺序执行
+// 同一步内的所有输入执行完才请求一次重绘，绘制在两步之间按显示帧率插值
+// 步由游戏调度器触发：有窗口时按真实时间，无窗口时按调度器的手动时钟，不需要等待
+class SimulationLoop
+{
+public:
+    // 加入一个按键输入
+    // key: Qt::Key
+    // stamp: 收到输入的时间
+    void postKey(int key, qint64 stamp);
+
+    // 加入一个点击输入
+    // cell: 点击的地图坐标
+    // stamp: 收到输入的时间
+    void postClick(const QPoint& cell, qint64 stamp);
+
+    // 是否有等待执行的输入
+    bool hasPending() const { return !queue.isEmpty(); }
+
+    // 取出本步要执行的全部输入，并推进步数
+    QVector<QueuedInput> take();
+
+    // 丢弃等待执行的输入（读档、快速读档后旧输入不再适用）
+    void clear() { queue.clear(); }
+
+    // 已执行的步数
+    qint64 steps() const { return stepCount; }
+
+    // 距下一个步边界的时间
+    // now: 当前游戏时间（毫秒）
+    // 返回毫秒数，正好在边界上时返回一个完整步长
+    static qint64 delayToNextStep(qint64 now);
+
+private:
+    QVector<QueuedInput> queue;  // 等待执行的输入，按到达顺序
+    qint64 stepCount = 0;        // 已执行的步数
+};
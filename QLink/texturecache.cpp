@@ -0,0 +1,59 @@
+#include "texturecache.h"
+
+// 设置贴图尺寸
+// size: 贴图的逻辑边长（像素）
+// dpr: 设备像素比
+void TextureCache::setSpriteSize(int newSize, qreal newDpr)
+{
+    if (newSize == size && qFuzzyCompare(newDpr, dpr)) return; // 尺寸未变化，沿用现有缓存
+    size = newSize;
+    dpr = newDpr;
+    // 每次尺寸变化只缩放一次，绘制时直接使用
+    for (auto it = sources.cbegin(); it != sources.cend(); ++it)
+        scaled.insert(it.key(), scaledFrom(it.value()));
+}
+
+// 获取缩放后的贴图
+// path: 贴图资源路径
+// mode: 缩放方式
+const QPixmap& TextureCache::pixmap(const QString& path, Qt::TransformationMode mode)
+{
+    auto it = scaled.find(path);
+    if (it != scaled.end()) return it.value();
+    Source source{QPixmap(path), mode}; // 首次使用，解码原始贴图
+    sources.insert(path, source);
+    return scaled.insert(path, scaledFrom(source)).value();
+}
+
+// 获取当前缓存对应的设备像素比
+qreal TextureCache::devicePixelRatio() const
+{
+    return dpr;
+}
+
+// 按当前尺寸和像素比缩放一张原始贴图
+// 按物理像素缩放后设置像素比，绘制时按逻辑尺寸一比一贴图
+QPixmap TextureCache::scaledFrom(const Source& source) const
+{
+    if (source.pixmap.isNull()) return QPixmap();
+    int physical = qMax(1, qRound(size * dpr));
+    QPixmap result = source.pixmap.scaled(physical, physical, Qt::KeepAspectRatio, source.mode);
+    result.setDevicePixelRatio(dpr);
+    return result;
+}
+
+// 按窗口尺寸缩放背景图
+// source: 原始背景图
+// size: 窗口逻辑尺寸
+// dpr: 设备像素比
+QPixmap scaledBackground(const QPixmap& source, const QSize& size, qreal dpr)
+{
+    if (source.isNull() || size.isEmpty()) return QPixmap();
+    QSize physical = size * dpr;
+    QPixmap scaled = source.scaled(physical, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    // 居中裁剪到窗口尺寸
+    QPixmap result = scaled.copy((scaled.width() - physical.width()) / 2, (scaled.height() - physical.height()) / 2,
+                                 physical.width(), physical.height());
+    result.setDevicePixelRatio(dpr);
+    return result;
+}
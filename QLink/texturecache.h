@@ -0,0 +1,48 @@
+#pragma once
+#include <QHash>
+#include <QPixmap>
+#include <QString>
+
+// 贴图缓存类
+// 每个贴图文件只解码一次，并按当前格子尺寸和设备像素比预先缩放
+// 窗口尺寸或设备像素比变化时统一重新缩放，绘制时直接取用，不再逐帧缩放
+class TextureCache
+{
+public:
+    // 设置贴图尺寸
+    // size: 贴图的逻辑边长（像素）
+    // dpr: 设备像素比
+    // 尺寸或像素比变化时，重新缩放所有已加载的贴图
+    void setSpriteSize(int size, qreal dpr);
+
+    // 获取缩放后的贴图
+    // path: 贴图资源路径
+    // mode: 缩放方式，首次加载时记录，像素风贴图使用FastTransformation保持清晰
+    // 返回按当前尺寸缩放好的贴图，首次使用时加载并缩放
+    const QPixmap& pixmap(const QString& path, Qt::TransformationMode mode = Qt::SmoothTransformation);
+
+    // 获取当前缓存对应的设备像素比
+    qreal devicePixelRatio() const;
+
+private:
+    // 原始贴图及其缩放方式
+    struct Source {
+        QPixmap pixmap;               // 解码后的原始贴图
+        Qt::TransformationMode mode;  // 缩放方式
+    };
+
+    // 按当前尺寸和像素比缩放一张原始贴图
+    QPixmap scaledFrom(const Source& source) const;
+
+    QHash<QString, Source> sources;   // 原始贴图，每个文件只解码一次
+    QHash<QString, QPixmap> scaled;   // 按当前尺寸缩放后的贴图
+    int size = 46;                    // 贴图逻辑边长（像素）
+    qreal dpr = 1.0;                  // 设备像素比
+};
+
+// 按窗口尺寸缩放背景图
+// source: 原始背景图
+// size: 窗口逻辑尺寸
+// dpr: 设备像素比
+// 返回铺满窗口的背景图，保持宽高比并居中裁剪，供绘制时直接贴图
+QPixmap scaledBackground(const QPixmap& source, const QSize& size, qreal dpr);
@@ -0,0 +1,105 @@
+#include "tilerenderer.h"
+#include <QThread>
+#include <cstring>
+#include "block.h"
+
+static const int tileCells = 16; // 每个分块的边长（格）
+
+// 构造函数
+TileRenderer::TileRenderer()
+{
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+// 设置格子尺寸和方块贴图
+void TileRenderer::setSprites(int newCellSize, int newMargin, qreal newDpr, const QVector<QImage>& newSprites)
+{
+    cellSize = newCellSize;
+    margin = newMargin;
+    dpr = newDpr;
+    sprites = newSprites;
+    rebuildTiles(); // 分块像素尺寸改变，全部重绘
+}
+
+// 更新棋盘内容
+// 逐分块逐行比较新旧内容，只标记发生变化的分块
+void TileRenderer::setBoard(int newRows, int newCols, const QByteArray& newCells)
+{
+    if (newRows != rows || newCols != cols || cells.size() != newCells.size()) {
+        rows = newRows;
+        cols = newCols;
+        cells = newCells;
+        rebuildTiles();
+        return;
+    }
+    const char* oldData = cells.constData();
+    const char* newData = newCells.constData();
+    for (Tile& tile : tiles) {
+        if (tile.dirty) continue;
+        for (int y = tile.cells.top(); y <= tile.cells.bottom(); ++y) {
+            int offset = y * cols + tile.cells.left();
+            if (std::memcmp(oldData + offset, newData + offset, tile.cells.width()) != 0) {
+                tile.dirty = true;
+                break;
+            }
+        }
+    }
+    cells = newCells;
+}
+
+// 重绘所有需要重绘的分块
+void TileRenderer::render()
+{
+    for (Tile& tile : tiles) {
+        if (!tile.dirty) continue;
+        Tile* target = &tile;
+        pool.start([this, target]() { rasterize(*target); });
+    }
+    pool.waitForDone(); // 等待本帧所有分块绘制完成再合成
+}
+
+// 将所有分块合成到画布上
+void TileRenderer::composite(QPainter& painter, const QPoint& origin) const
+{
+    for (const Tile& tile : tiles)
+        painter.drawImage(QPoint(origin.x() + tile.cells.left() * cellSize, origin.y() + tile.cells.top() * cellSize), tile.image);
+}
+
+// 绘制一个分块，在工作线程中执行
+// 每个分块只写自己的图像，贴图和棋盘内容只读，因此无需加锁
+void TileRenderer::rasterize(Tile& tile) const
+{
+    if (tile.image.isNull()) {
+        tile.image = QImage(qRound(tile.cells.width() * cellSize * dpr), qRound(tile.cells.height() * cellSize * dpr),
+                            QImage::Format_ARGB32_Premultiplied);
+        tile.image.setDevicePixelRatio(dpr);
+    }
+    tile.image.fill(Qt::transparent);
+    QPainter painter(&tile.image);
+    const uchar* data = reinterpret_cast<const uchar*>(cells.constData());
+    for (int y = tile.cells.top(); y <= tile.cells.bottom(); ++y) {
+        for (int x = tile.cells.left(); x <= tile.cells.right(); ++x) {
+            uchar cell = data[y * cols + x];
+            int state = packedState(cell);
+            int form = packedForm(cell);
+            if (state == 0 || state > 2 || form < 0) continue;
+            int index = form * 2 + state - 1;
+            if (index >= sprites.size()) continue;
+            painter.drawImage(QPointF((x - tile.cells.left()) * cellSize + margin, (y - tile.cells.top()) * cellSize + margin), sprites[index]);
+        }
+    }
+    tile.dirty = false;
+}
+
+// 按当前棋盘尺寸重新切分分块
+void TileRenderer::rebuildTiles()
+{
+    tiles.clear();
+    for (int y = 0; y < rows; y += tileCells) {
+        for (int x = 0; x < cols; x += tileCells) {
+            Tile tile;
+            tile.cells = QRect(x, y, qMin(tileCells, cols - x), qMin(tileCells, rows - y));
+            tiles.append(tile);
+        }
+    }
+}
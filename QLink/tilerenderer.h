@@ -0,0 +1,70 @@
+#pragma once
+#include <QByteArray>
+#include <QImage>
+#include <QPainter>
+#include <QPoint>
+#include <QRect>
+#include <QThreadPool>
+#include <QVector>
+
+// 分块并行渲染器
+// 将棋盘按固定格数切分成若干分块，每个分块在线程池中独立绘制到QImage
+// 只重绘格子内容发生变化的分块，最后在GUI线程中合成
+// 用于超大棋盘，普通棋盘仍使用单线程QPainter直接绘制
+class TileRenderer
+{
+    friend class SimpleTest;
+
+public:
+    // 构造函数
+    // 创建渲染线程池，线程数与CPU核心数一致
+    TileRenderer();
+
+    // 设置格子尺寸和方块贴图
+    // cellSize: 格子逻辑边长（像素）
+    // margin: 贴图与格子边缘的间距（像素）
+    // dpr: 设备像素比
+    // sprites: 方块贴图，按 形状*2+状态-1 排列，需已按格子尺寸缩放
+    // 调用后所有分块都需要重绘
+    void setSprites(int cellSize, int margin, qreal dpr, const QVector<QImage>& sprites);
+
+    // 更新棋盘内容
+    // rows: 棋盘行数
+    // cols: 棋盘列数
+    // cells: 压缩后的格子数据，每格一个字节（见packBlock），按行存储
+    // 与上一次的内容逐分块比较，只标记发生变化的分块
+    void setBoard(int rows, int cols, const QByteArray& cells);
+
+    // 重绘所有需要重绘的分块
+    // 各分块在线程池中并行绘制，函数返回时全部绘制完成
+    void render();
+
+    // 将所有分块合成到画布上
+    // painter: GUI线程中的绘图对象
+    // origin: 棋盘左上角的像素坐标
+    void composite(QPainter& painter, const QPoint& origin) const;
+
+private:
+    // 单个分块
+    struct Tile {
+        QRect cells;        // 分块覆盖的格子范围
+        QImage image;       // 分块绘制结果
+        bool dirty = true;  // 是否需要重绘
+    };
+
+    // 绘制一个分块，在工作线程中执行
+    // tile: 要绘制的分块
+    void rasterize(Tile& tile) const;
+
+    // 按当前棋盘尺寸重新切分分块
+    void rebuildTiles();
+
+    QThreadPool pool;                // 渲染线程池
+    QVector<Tile> tiles;             // 所有分块
+    QVector<QImage> sprites;         // 方块贴图，工作线程只读
+    QByteArray cells;                // 当前棋盘内容
+    int rows = 0, cols = 0;          // 棋盘行数和列数
+    int cellSize = 50;               // 格子逻辑边长（像素）
+    int margin = 2;                  // 贴图与格子边缘的间距（像素）
+    qreal dpr = 1.0;                 // 设备像素比
+};